@@ -46,6 +46,26 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// bdhAsync_Impl
+SEXP bdhAsync_Impl(SEXP con_, std::vector<std::string> securities, std::vector<std::string> fields, std::string start_date_, SEXP end_date_, SEXP options_, SEXP overrides_, bool verbose, SEXP identity_, bool int_as_double);
+RcppExport SEXP _Rblpapi_bdhAsync_Impl(SEXP con_SEXP, SEXP securitiesSEXP, SEXP fieldsSEXP, SEXP start_date_SEXP, SEXP end_date_SEXP, SEXP options_SEXP, SEXP overrides_SEXP, SEXP verboseSEXP, SEXP identity_SEXP, SEXP int_as_doubleSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type con_(con_SEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type securities(securitiesSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type fields(fieldsSEXP);
+    Rcpp::traits::input_parameter< std::string >::type start_date_(start_date_SEXP);
+    Rcpp::traits::input_parameter< SEXP >::type end_date_(end_date_SEXP);
+    Rcpp::traits::input_parameter< SEXP >::type options_(options_SEXP);
+    Rcpp::traits::input_parameter< SEXP >::type overrides_(overrides_SEXP);
+    Rcpp::traits::input_parameter< bool >::type verbose(verboseSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type identity_(identity_SEXP);
+    Rcpp::traits::input_parameter< bool >::type int_as_double(int_as_doubleSEXP);
+    rcpp_result_gen = Rcpp::wrap(bdhAsync_Impl(con_, securities, fields, start_date_, end_date_, options_, overrides_, verbose, identity_, int_as_double));
+    return rcpp_result_gen;
+END_RCPP
+}
 // bdp_Impl
 Rcpp::List bdp_Impl(SEXP con_, std::vector<std::string> securities, std::vector<std::string> fields, SEXP options_, SEXP overrides_, bool verbose, SEXP identity_);
 RcppExport SEXP _Rblpapi_bdp_Impl(SEXP con_SEXP, SEXP securitiesSEXP, SEXP fieldsSEXP, SEXP options_SEXP, SEXP overrides_SEXP, SEXP verboseSEXP, SEXP identity_SEXP) {
@@ -63,6 +83,84 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// bdpAsync_Impl
+SEXP bdpAsync_Impl(SEXP con_, std::vector<std::string> securities, std::vector<std::string> fields, SEXP options_, SEXP overrides_, bool verbose, SEXP identity_);
+RcppExport SEXP _Rblpapi_bdpAsync_Impl(SEXP con_SEXP, SEXP securitiesSEXP, SEXP fieldsSEXP, SEXP options_SEXP, SEXP overrides_SEXP, SEXP verboseSEXP, SEXP identity_SEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type con_(con_SEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type securities(securitiesSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type fields(fieldsSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type options_(options_SEXP);
+    Rcpp::traits::input_parameter< SEXP >::type overrides_(overrides_SEXP);
+    Rcpp::traits::input_parameter< bool >::type verbose(verboseSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type identity_(identity_SEXP);
+    rcpp_result_gen = Rcpp::wrap(bdpAsync_Impl(con_, securities, fields, options_, overrides_, verbose, identity_));
+    return rcpp_result_gen;
+END_RCPP
+}
+// bdpPrepare_Impl
+SEXP bdpPrepare_Impl(SEXP con_, std::vector<std::string> fields, SEXP options_, SEXP overrides_, bool verbose, SEXP identity_);
+RcppExport SEXP _Rblpapi_bdpPrepare_Impl(SEXP con_SEXP, SEXP fieldsSEXP, SEXP options_SEXP, SEXP overrides_SEXP, SEXP verboseSEXP, SEXP identity_SEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type con_(con_SEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type fields(fieldsSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type options_(options_SEXP);
+    Rcpp::traits::input_parameter< SEXP >::type overrides_(overrides_SEXP);
+    Rcpp::traits::input_parameter< bool >::type verbose(verboseSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type identity_(identity_SEXP);
+    rcpp_result_gen = Rcpp::wrap(bdpPrepare_Impl(con_, fields, options_, overrides_, verbose, identity_));
+    return rcpp_result_gen;
+END_RCPP
+}
+// bdpExecute_Impl
+Rcpp::List bdpExecute_Impl(SEXP prepared_, std::vector<std::string> securities);
+RcppExport SEXP _Rblpapi_bdpExecute_Impl(SEXP prepared_SEXP, SEXP securitiesSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type prepared_(prepared_SEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type securities(securitiesSEXP);
+    rcpp_result_gen = Rcpp::wrap(bdpExecute_Impl(prepared_, securities));
+    return rcpp_result_gen;
+END_RCPP
+}
+// bdpRows_Impl
+Rcpp::List bdpRows_Impl(SEXP con_, std::vector<std::string> securities, std::vector<std::string> fields, SEXP options_, Rcpp::List overrides, bool verbose, SEXP identity_);
+RcppExport SEXP _Rblpapi_bdpRows_Impl(SEXP con_SEXP, SEXP securitiesSEXP, SEXP fieldsSEXP, SEXP options_SEXP, SEXP overridesSEXP, SEXP verboseSEXP, SEXP identity_SEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type con_(con_SEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type securities(securitiesSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type fields(fieldsSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type options_(options_SEXP);
+    Rcpp::traits::input_parameter< Rcpp::List >::type overrides(overridesSEXP);
+    Rcpp::traits::input_parameter< bool >::type verbose(verboseSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type identity_(identity_SEXP);
+    rcpp_result_gen = Rcpp::wrap(bdpRows_Impl(con_, securities, fields, options_, overrides, verbose, identity_));
+    return rcpp_result_gen;
+END_RCPP
+}
+// bdpBatch_Impl
+Rcpp::List bdpBatch_Impl(SEXP con_, Rcpp::List queries, SEXP options_, int maxFields, int maxCells, SEXP identity_);
+RcppExport SEXP _Rblpapi_bdpBatch_Impl(SEXP con_SEXP, SEXP queriesSEXP, SEXP options_SEXP, SEXP maxFieldsSEXP, SEXP maxCellsSEXP, SEXP identity_SEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type con_(con_SEXP);
+    Rcpp::traits::input_parameter< Rcpp::List >::type queries(queriesSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type options_(options_SEXP);
+    Rcpp::traits::input_parameter< int >::type maxFields(maxFieldsSEXP);
+    Rcpp::traits::input_parameter< int >::type maxCells(maxCellsSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type identity_(identity_SEXP);
+    rcpp_result_gen = Rcpp::wrap(bdpBatch_Impl(con_, queries, options_, maxFields, maxCells, identity_));
+    return rcpp_result_gen;
+END_RCPP
+}
 // bds_Impl
 Rcpp::List bds_Impl(SEXP con_, std::vector<std::string> securities, std::string field, SEXP options_, SEXP overrides_, bool verbose, SEXP identity_);
 RcppExport SEXP _Rblpapi_bds_Impl(SEXP con_SEXP, SEXP securitiesSEXP, SEXP fieldSEXP, SEXP options_SEXP, SEXP overrides_SEXP, SEXP verboseSEXP, SEXP identity_SEXP) {
@@ -115,8 +213,8 @@ BEGIN_RCPP
 END_RCPP
 }
 // blpConnect_Impl
-SEXP blpConnect_Impl(const std::string host, const int port, SEXP app_name_, SEXP app_identity_key_);
-RcppExport SEXP _Rblpapi_blpConnect_Impl(SEXP hostSEXP, SEXP portSEXP, SEXP app_name_SEXP, SEXP app_identity_key_SEXP) {
+SEXP blpConnect_Impl(const std::string host, const int port, SEXP app_name_, SEXP app_identity_key_, std::vector<std::string> services, int timeout);
+RcppExport SEXP _Rblpapi_blpConnect_Impl(SEXP hostSEXP, SEXP portSEXP, SEXP app_name_SEXP, SEXP app_identity_key_SEXP, SEXP servicesSEXP, SEXP timeoutSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -124,7 +222,26 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< const int >::type port(portSEXP);
     Rcpp::traits::input_parameter< SEXP >::type app_name_(app_name_SEXP);
     Rcpp::traits::input_parameter< SEXP >::type app_identity_key_(app_identity_key_SEXP);
-    rcpp_result_gen = Rcpp::wrap(blpConnect_Impl(host, port, app_name_, app_identity_key_));
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type services(servicesSEXP);
+    Rcpp::traits::input_parameter< int >::type timeout(timeoutSEXP);
+    rcpp_result_gen = Rcpp::wrap(blpConnect_Impl(host, port, app_name_, app_identity_key_, services, timeout));
+    return rcpp_result_gen;
+END_RCPP
+}
+// blpConnectRouter_Impl
+SEXP blpConnectRouter_Impl(const std::string host, const int port, SEXP app_name_, SEXP app_identity_key_, int threads, std::vector<std::string> services, int timeout);
+RcppExport SEXP _Rblpapi_blpConnectRouter_Impl(SEXP hostSEXP, SEXP portSEXP, SEXP app_name_SEXP, SEXP app_identity_key_SEXP, SEXP threadsSEXP, SEXP servicesSEXP, SEXP timeoutSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::string >::type host(hostSEXP);
+    Rcpp::traits::input_parameter< const int >::type port(portSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type app_name_(app_name_SEXP);
+    Rcpp::traits::input_parameter< SEXP >::type app_identity_key_(app_identity_key_SEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type services(servicesSEXP);
+    Rcpp::traits::input_parameter< int >::type timeout(timeoutSEXP);
+    rcpp_result_gen = Rcpp::wrap(blpConnectRouter_Impl(host, port, app_name_, app_identity_key_, threads, services, timeout));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -172,6 +289,82 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// blpConnectPool_Impl
+SEXP blpConnectPool_Impl(std::vector<std::string> hosts, std::vector<int> ports, SEXP app_name_, SEXP app_identity_key_, int threads, std::string balance, int maxFailures, double retryAfter, std::vector<std::string> services, int timeout);
+RcppExport SEXP _Rblpapi_blpConnectPool_Impl(SEXP hostsSEXP, SEXP portsSEXP, SEXP app_name_SEXP, SEXP app_identity_key_SEXP, SEXP threadsSEXP, SEXP balanceSEXP, SEXP maxFailuresSEXP, SEXP retryAfterSEXP, SEXP servicesSEXP, SEXP timeoutSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type hosts(hostsSEXP);
+    Rcpp::traits::input_parameter< std::vector<int> >::type ports(portsSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type app_name_(app_name_SEXP);
+    Rcpp::traits::input_parameter< SEXP >::type app_identity_key_(app_identity_key_SEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< std::string >::type balance(balanceSEXP);
+    Rcpp::traits::input_parameter< int >::type maxFailures(maxFailuresSEXP);
+    Rcpp::traits::input_parameter< double >::type retryAfter(retryAfterSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type services(servicesSEXP);
+    Rcpp::traits::input_parameter< int >::type timeout(timeoutSEXP);
+    rcpp_result_gen = Rcpp::wrap(blpConnectPool_Impl(hosts, ports, app_name_, app_identity_key_, threads, balance, maxFailures, retryAfter, services, timeout));
+    return rcpp_result_gen;
+END_RCPP
+}
+// poolStatus_Impl
+Rcpp::DataFrame poolStatus_Impl(SEXP con_);
+RcppExport SEXP _Rblpapi_poolStatus_Impl(SEXP con_SEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type con_(con_SEXP);
+    rcpp_result_gen = Rcpp::wrap(poolStatus_Impl(con_));
+    return rcpp_result_gen;
+END_RCPP
+}
+// requestStatus_Impl
+Rcpp::List requestStatus_Impl(SEXP handle_);
+RcppExport SEXP _Rblpapi_requestStatus_Impl(SEXP handle_SEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type handle_(handle_SEXP);
+    rcpp_result_gen = Rcpp::wrap(requestStatus_Impl(handle_));
+    return rcpp_result_gen;
+END_RCPP
+}
+// waitRequest_Impl
+bool waitRequest_Impl(SEXP handle_, int timeout);
+RcppExport SEXP _Rblpapi_waitRequest_Impl(SEXP handle_SEXP, SEXP timeoutSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type handle_(handle_SEXP);
+    Rcpp::traits::input_parameter< int >::type timeout(timeoutSEXP);
+    rcpp_result_gen = Rcpp::wrap(waitRequest_Impl(handle_, timeout));
+    return rcpp_result_gen;
+END_RCPP
+}
+// cancelRequest_Impl
+SEXP cancelRequest_Impl(SEXP handle_);
+RcppExport SEXP _Rblpapi_cancelRequest_Impl(SEXP handle_SEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type handle_(handle_SEXP);
+    rcpp_result_gen = Rcpp::wrap(cancelRequest_Impl(handle_));
+    return rcpp_result_gen;
+END_RCPP
+}
+// collectRequest_Impl
+SEXP collectRequest_Impl(SEXP handle_);
+RcppExport SEXP _Rblpapi_collectRequest_Impl(SEXP handle_SEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type handle_(handle_SEXP);
+    rcpp_result_gen = Rcpp::wrap(collectRequest_Impl(handle_));
+    return rcpp_result_gen;
+END_RCPP
+}
 // fieldSearch_Impl
 Rcpp::DataFrame fieldSearch_Impl(SEXP con, std::string searchterm);
 RcppExport SEXP _Rblpapi_fieldSearch_Impl(SEXP conSEXP, SEXP searchtermSEXP) {
@@ -202,6 +395,35 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// getBarsCached_Impl
+Rcpp::DataFrame getBarsCached_Impl(SEXP con, std::string security, std::string eventType, int barInterval, double startTime, double endTime, Rcpp::Nullable<Rcpp::CharacterVector> options, bool verbose);
+RcppExport SEXP _Rblpapi_getBarsCached_Impl(SEXP conSEXP, SEXP securitySEXP, SEXP eventTypeSEXP, SEXP barIntervalSEXP, SEXP startTimeSEXP, SEXP endTimeSEXP, SEXP optionsSEXP, SEXP verboseSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type con(conSEXP);
+    Rcpp::traits::input_parameter< std::string >::type security(securitySEXP);
+    Rcpp::traits::input_parameter< std::string >::type eventType(eventTypeSEXP);
+    Rcpp::traits::input_parameter< int >::type barInterval(barIntervalSEXP);
+    Rcpp::traits::input_parameter< double >::type startTime(startTimeSEXP);
+    Rcpp::traits::input_parameter< double >::type endTime(endTimeSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::CharacterVector> >::type options(optionsSEXP);
+    Rcpp::traits::input_parameter< bool >::type verbose(verboseSEXP);
+    rcpp_result_gen = Rcpp::wrap(getBarsCached_Impl(con, security, eventType, barInterval, startTime, endTime, options, verbose));
+    return rcpp_result_gen;
+END_RCPP
+}
+// clearBarCache_Impl
+SEXP clearBarCache_Impl(SEXP security_);
+RcppExport SEXP _Rblpapi_clearBarCache_Impl(SEXP security_SEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type security_(security_SEXP);
+    rcpp_result_gen = Rcpp::wrap(clearBarCache_Impl(security_));
+    return rcpp_result_gen;
+END_RCPP
+}
 // fieldInfo_Impl
 Rcpp::List fieldInfo_Impl(SEXP con_, std::vector<std::string> fields);
 RcppExport SEXP _Rblpapi_fieldInfo_Impl(SEXP con_SEXP, SEXP fieldsSEXP) {
@@ -231,6 +453,22 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// getQuotedTrades_Impl
+Rcpp::DataFrame getQuotedTrades_Impl(SEXP con, std::string security, std::vector<std::string> eventType, std::string startDateTime, std::string endDateTime, bool verbose);
+RcppExport SEXP _Rblpapi_getQuotedTrades_Impl(SEXP conSEXP, SEXP securitySEXP, SEXP eventTypeSEXP, SEXP startDateTimeSEXP, SEXP endDateTimeSEXP, SEXP verboseSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type con(conSEXP);
+    Rcpp::traits::input_parameter< std::string >::type security(securitySEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type eventType(eventTypeSEXP);
+    Rcpp::traits::input_parameter< std::string >::type startDateTime(startDateTimeSEXP);
+    Rcpp::traits::input_parameter< std::string >::type endDateTime(endDateTimeSEXP);
+    Rcpp::traits::input_parameter< bool >::type verbose(verboseSEXP);
+    rcpp_result_gen = Rcpp::wrap(getQuotedTrades_Impl(con, security, eventType, startDateTime, endDateTime, verbose));
+    return rcpp_result_gen;
+END_RCPP
+}
 // lookup_Impl
 Rcpp::DataFrame lookup_Impl(SEXP con, std::string query, std::string yellowKeyFilter, std::string languageOverride, int maxResults, bool verbose);
 RcppExport SEXP _Rblpapi_lookup_Impl(SEXP conSEXP, SEXP querySEXP, SEXP yellowKeyFilterSEXP, SEXP languageOverrideSEXP, SEXP maxResultsSEXP, SEXP verboseSEXP) {
@@ -247,9 +485,107 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// bdpMembers_Impl
+Rcpp::List bdpMembers_Impl(SEXP con_, std::string kind, Rcpp::List source, std::vector<std::string> fields, SEXP options_, SEXP overrides_, std::string column, std::string yellowKey, int batchSize, bool verbose, SEXP identity_);
+RcppExport SEXP _Rblpapi_bdpMembers_Impl(SEXP con_SEXP, SEXP kindSEXP, SEXP sourceSEXP, SEXP fieldsSEXP, SEXP options_SEXP, SEXP overrides_SEXP, SEXP columnSEXP, SEXP yellowKeySEXP, SEXP batchSizeSEXP, SEXP verboseSEXP, SEXP identity_SEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type con_(con_SEXP);
+    Rcpp::traits::input_parameter< std::string >::type kind(kindSEXP);
+    Rcpp::traits::input_parameter< Rcpp::List >::type source(sourceSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type fields(fieldsSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type options_(options_SEXP);
+    Rcpp::traits::input_parameter< SEXP >::type overrides_(overrides_SEXP);
+    Rcpp::traits::input_parameter< std::string >::type column(columnSEXP);
+    Rcpp::traits::input_parameter< std::string >::type yellowKey(yellowKeySEXP);
+    Rcpp::traits::input_parameter< int >::type batchSize(batchSizeSEXP);
+    Rcpp::traits::input_parameter< bool >::type verbose(verboseSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type identity_(identity_SEXP);
+    rcpp_result_gen = Rcpp::wrap(bdpMembers_Impl(con_, kind, source, fields, options_, overrides_, column, yellowKey, batchSize, verbose, identity_));
+    return rcpp_result_gen;
+END_RCPP
+}
+// replayDepth_Impl
+Rcpp::List replayDepth_Impl(std::vector<std::string> side, std::vector<std::string> command, std::vector<int> position, std::vector<double> price, std::vector<double> size, std::vector<int> orders, int levels, int n);
+RcppExport SEXP _Rblpapi_replayDepth_Impl(SEXP sideSEXP, SEXP commandSEXP, SEXP positionSEXP, SEXP priceSEXP, SEXP sizeSEXP, SEXP ordersSEXP, SEXP levelsSEXP, SEXP nSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type side(sideSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type command(commandSEXP);
+    Rcpp::traits::input_parameter< std::vector<int> >::type position(positionSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type price(priceSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type size(sizeSEXP);
+    Rcpp::traits::input_parameter< std::vector<int> >::type orders(ordersSEXP);
+    Rcpp::traits::input_parameter< int >::type levels(levelsSEXP);
+    Rcpp::traits::input_parameter< int >::type n(nSEXP);
+    rcpp_result_gen = Rcpp::wrap(replayDepth_Impl(side, command, position, price, size, orders, levels, n));
+    return rcpp_result_gen;
+END_RCPP
+}
+// replayJournal_Impl
+Rcpp::List replayJournal_Impl(std::string journal, Rcpp::Function fun, double speed, int batchSize, int batchInterval, double startTime, double endTime);
+RcppExport SEXP _Rblpapi_replayJournal_Impl(SEXP journalSEXP, SEXP funSEXP, SEXP speedSEXP, SEXP batchSizeSEXP, SEXP batchIntervalSEXP, SEXP startTimeSEXP, SEXP endTimeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type journal(journalSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Function >::type fun(funSEXP);
+    Rcpp::traits::input_parameter< double >::type speed(speedSEXP);
+    Rcpp::traits::input_parameter< int >::type batchSize(batchSizeSEXP);
+    Rcpp::traits::input_parameter< int >::type batchInterval(batchIntervalSEXP);
+    Rcpp::traits::input_parameter< double >::type startTime(startTimeSEXP);
+    Rcpp::traits::input_parameter< double >::type endTime(endTimeSEXP);
+    rcpp_result_gen = Rcpp::wrap(replayJournal_Impl(journal, fun, speed, batchSize, batchInterval, startTime, endTime));
+    return rcpp_result_gen;
+END_RCPP
+}
+// requestStatistics_Impl
+Rcpp::List requestStatistics_Impl(bool reset);
+RcppExport SEXP _Rblpapi_requestStatistics_Impl(SEXP resetSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< bool >::type reset(resetSEXP);
+    rcpp_result_gen = Rcpp::wrap(requestStatistics_Impl(reset));
+    return rcpp_result_gen;
+END_RCPP
+}
+// setThrottle_Impl
+SEXP setThrottle_Impl(SEXP con_, bool enabled, double rate, double burst, double minWindow, double maxWindow, double latency, double minCells, double maxCells);
+RcppExport SEXP _Rblpapi_setThrottle_Impl(SEXP con_SEXP, SEXP enabledSEXP, SEXP rateSEXP, SEXP burstSEXP, SEXP minWindowSEXP, SEXP maxWindowSEXP, SEXP latencySEXP, SEXP minCellsSEXP, SEXP maxCellsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type con_(con_SEXP);
+    Rcpp::traits::input_parameter< bool >::type enabled(enabledSEXP);
+    Rcpp::traits::input_parameter< double >::type rate(rateSEXP);
+    Rcpp::traits::input_parameter< double >::type burst(burstSEXP);
+    Rcpp::traits::input_parameter< double >::type minWindow(minWindowSEXP);
+    Rcpp::traits::input_parameter< double >::type maxWindow(maxWindowSEXP);
+    Rcpp::traits::input_parameter< double >::type latency(latencySEXP);
+    Rcpp::traits::input_parameter< double >::type minCells(minCellsSEXP);
+    Rcpp::traits::input_parameter< double >::type maxCells(maxCellsSEXP);
+    rcpp_result_gen = Rcpp::wrap(setThrottle_Impl(con_, enabled, rate, burst, minWindow, maxWindow, latency, minCells, maxCells));
+    return rcpp_result_gen;
+END_RCPP
+}
+// throttleStatus_Impl
+Rcpp::DataFrame throttleStatus_Impl(SEXP con_, bool reset);
+RcppExport SEXP _Rblpapi_throttleStatus_Impl(SEXP con_SEXP, SEXP resetSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type con_(con_SEXP);
+    Rcpp::traits::input_parameter< bool >::type reset(resetSEXP);
+    rcpp_result_gen = Rcpp::wrap(throttleStatus_Impl(con_, reset));
+    return rcpp_result_gen;
+END_RCPP
+}
 // subscribe_Impl
-SEXP subscribe_Impl(SEXP con_, std::vector<std::string> securities, std::vector<std::string> fields, Rcpp::Function fun, SEXP options_, SEXP identity_);
-RcppExport SEXP _Rblpapi_subscribe_Impl(SEXP con_SEXP, SEXP securitiesSEXP, SEXP fieldsSEXP, SEXP funSEXP, SEXP options_SEXP, SEXP identity_SEXP) {
+SEXP subscribe_Impl(SEXP con_, std::vector<std::string> securities, std::vector<std::string> fields, Rcpp::Function fun, SEXP options_, SEXP identity_, int batchSize, int batchInterval, bool keepUnknown, int conflate, SEXP changes_, SEXP tolerance_);
+RcppExport SEXP _Rblpapi_subscribe_Impl(SEXP con_SEXP, SEXP securitiesSEXP, SEXP fieldsSEXP, SEXP funSEXP, SEXP options_SEXP, SEXP identity_SEXP, SEXP batchSizeSEXP, SEXP batchIntervalSEXP, SEXP keepUnknownSEXP, SEXP conflateSEXP, SEXP changes_SEXP, SEXP tolerance_SEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -259,7 +595,189 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< Rcpp::Function >::type fun(funSEXP);
     Rcpp::traits::input_parameter< SEXP >::type options_(options_SEXP);
     Rcpp::traits::input_parameter< SEXP >::type identity_(identity_SEXP);
-    rcpp_result_gen = Rcpp::wrap(subscribe_Impl(con_, securities, fields, fun, options_, identity_));
+    Rcpp::traits::input_parameter< int >::type batchSize(batchSizeSEXP);
+    Rcpp::traits::input_parameter< int >::type batchInterval(batchIntervalSEXP);
+    Rcpp::traits::input_parameter< bool >::type keepUnknown(keepUnknownSEXP);
+    Rcpp::traits::input_parameter< int >::type conflate(conflateSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type changes_(changes_SEXP);
+    Rcpp::traits::input_parameter< SEXP >::type tolerance_(tolerance_SEXP);
+    rcpp_result_gen = Rcpp::wrap(subscribe_Impl(con_, securities, fields, fun, options_, identity_, batchSize, batchInterval, keepUnknown, conflate, changes_, tolerance_));
+    return rcpp_result_gen;
+END_RCPP
+}
+// subscribeAsync_Impl
+SEXP subscribeAsync_Impl(const std::string host, const int port, SEXP app_name_, SEXP app_identity_key_, std::vector<std::string> securities, std::vector<std::string> fields, SEXP options_, int queueSize, bool keepUnknown, int conflate, SEXP journal_, double journalSegmentSize, double journalRotate, int retainRows, double retainBytes, int depthLevels, SEXP changes_, SEXP tolerance_);
+RcppExport SEXP _Rblpapi_subscribeAsync_Impl(SEXP hostSEXP, SEXP portSEXP, SEXP app_name_SEXP, SEXP app_identity_key_SEXP, SEXP securitiesSEXP, SEXP fieldsSEXP, SEXP options_SEXP, SEXP queueSizeSEXP, SEXP keepUnknownSEXP, SEXP conflateSEXP, SEXP journal_SEXP, SEXP journalSegmentSizeSEXP, SEXP journalRotateSEXP, SEXP retainRowsSEXP, SEXP retainBytesSEXP, SEXP depthLevelsSEXP, SEXP changes_SEXP, SEXP tolerance_SEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::string >::type host(hostSEXP);
+    Rcpp::traits::input_parameter< const int >::type port(portSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type app_name_(app_name_SEXP);
+    Rcpp::traits::input_parameter< SEXP >::type app_identity_key_(app_identity_key_SEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type securities(securitiesSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type fields(fieldsSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type options_(options_SEXP);
+    Rcpp::traits::input_parameter< int >::type queueSize(queueSizeSEXP);
+    Rcpp::traits::input_parameter< bool >::type keepUnknown(keepUnknownSEXP);
+    Rcpp::traits::input_parameter< int >::type conflate(conflateSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type journal_(journal_SEXP);
+    Rcpp::traits::input_parameter< double >::type journalSegmentSize(journalSegmentSizeSEXP);
+    Rcpp::traits::input_parameter< double >::type journalRotate(journalRotateSEXP);
+    Rcpp::traits::input_parameter< int >::type retainRows(retainRowsSEXP);
+    Rcpp::traits::input_parameter< double >::type retainBytes(retainBytesSEXP);
+    Rcpp::traits::input_parameter< int >::type depthLevels(depthLevelsSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type changes_(changes_SEXP);
+    Rcpp::traits::input_parameter< SEXP >::type tolerance_(tolerance_SEXP);
+    rcpp_result_gen = Rcpp::wrap(subscribeAsync_Impl(host, port, app_name_, app_identity_key_, securities, fields, options_, queueSize, keepUnknown, conflate, journal_, journalSegmentSize, journalRotate, retainRows, retainBytes, depthLevels, changes_, tolerance_));
+    return rcpp_result_gen;
+END_RCPP
+}
+// pollSubscription_Impl
+SEXP pollSubscription_Impl(SEXP engine_, int maxUpdates, int timeout);
+RcppExport SEXP _Rblpapi_pollSubscription_Impl(SEXP engine_SEXP, SEXP maxUpdatesSEXP, SEXP timeoutSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type engine_(engine_SEXP);
+    Rcpp::traits::input_parameter< int >::type maxUpdates(maxUpdatesSEXP);
+    Rcpp::traits::input_parameter< int >::type timeout(timeoutSEXP);
+    rcpp_result_gen = Rcpp::wrap(pollSubscription_Impl(engine_, maxUpdates, timeout));
+    return rcpp_result_gen;
+END_RCPP
+}
+// subscriptionSnapshot_Impl
+SEXP subscriptionSnapshot_Impl(SEXP engine_);
+RcppExport SEXP _Rblpapi_subscriptionSnapshot_Impl(SEXP engine_SEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type engine_(engine_SEXP);
+    rcpp_result_gen = Rcpp::wrap(subscriptionSnapshot_Impl(engine_));
+    return rcpp_result_gen;
+END_RCPP
+}
+// changeSubscription_Impl
+SEXP changeSubscription_Impl(SEXP engine_, const std::string action, std::vector<std::string> securities, SEXP fields_, SEXP options_);
+RcppExport SEXP _Rblpapi_changeSubscription_Impl(SEXP engine_SEXP, SEXP actionSEXP, SEXP securitiesSEXP, SEXP fields_SEXP, SEXP options_SEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type engine_(engine_SEXP);
+    Rcpp::traits::input_parameter< const std::string >::type action(actionSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type securities(securitiesSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type fields_(fields_SEXP);
+    Rcpp::traits::input_parameter< SEXP >::type options_(options_SEXP);
+    rcpp_result_gen = Rcpp::wrap(changeSubscription_Impl(engine_, action, securities, fields_, options_));
+    return rcpp_result_gen;
+END_RCPP
+}
+// subscriptionBars_Impl
+SEXP subscriptionBars_Impl(SEXP engine_, SEXP con, int barInterval, int capacity, const std::string eventType, const std::string priceField, const std::string sizeField, double startTime);
+RcppExport SEXP _Rblpapi_subscriptionBars_Impl(SEXP engine_SEXP, SEXP conSEXP, SEXP barIntervalSEXP, SEXP capacitySEXP, SEXP eventTypeSEXP, SEXP priceFieldSEXP, SEXP sizeFieldSEXP, SEXP startTimeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type engine_(engine_SEXP);
+    Rcpp::traits::input_parameter< SEXP >::type con(conSEXP);
+    Rcpp::traits::input_parameter< int >::type barInterval(barIntervalSEXP);
+    Rcpp::traits::input_parameter< int >::type capacity(capacitySEXP);
+    Rcpp::traits::input_parameter< const std::string >::type eventType(eventTypeSEXP);
+    Rcpp::traits::input_parameter< const std::string >::type priceField(priceFieldSEXP);
+    Rcpp::traits::input_parameter< const std::string >::type sizeField(sizeFieldSEXP);
+    Rcpp::traits::input_parameter< double >::type startTime(startTimeSEXP);
+    rcpp_result_gen = Rcpp::wrap(subscriptionBars_Impl(engine_, con, barInterval, capacity, eventType, priceField, sizeField, startTime));
+    return rcpp_result_gen;
+END_RCPP
+}
+// getSubscriptionBars_Impl
+Rcpp::DataFrame getSubscriptionBars_Impl(SEXP engine_, int n, bool current);
+RcppExport SEXP _Rblpapi_getSubscriptionBars_Impl(SEXP engine_SEXP, SEXP nSEXP, SEXP currentSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type engine_(engine_SEXP);
+    Rcpp::traits::input_parameter< int >::type n(nSEXP);
+    Rcpp::traits::input_parameter< bool >::type current(currentSEXP);
+    rcpp_result_gen = Rcpp::wrap(getSubscriptionBars_Impl(engine_, n, current));
+    return rcpp_result_gen;
+END_RCPP
+}
+// subscriptionWindow_Impl
+SEXP subscriptionWindow_Impl(SEXP engine_, SEXP securities_, int n, double since);
+RcppExport SEXP _Rblpapi_subscriptionWindow_Impl(SEXP engine_SEXP, SEXP securities_SEXP, SEXP nSEXP, SEXP sinceSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type engine_(engine_SEXP);
+    Rcpp::traits::input_parameter< SEXP >::type securities_(securities_SEXP);
+    Rcpp::traits::input_parameter< int >::type n(nSEXP);
+    Rcpp::traits::input_parameter< double >::type since(sinceSEXP);
+    rcpp_result_gen = Rcpp::wrap(subscriptionWindow_Impl(engine_, securities_, n, since));
+    return rcpp_result_gen;
+END_RCPP
+}
+// bookSnapshot_Impl
+Rcpp::DataFrame bookSnapshot_Impl(SEXP engine_, SEXP securities_, int n);
+RcppExport SEXP _Rblpapi_bookSnapshot_Impl(SEXP engine_SEXP, SEXP securities_SEXP, SEXP nSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type engine_(engine_SEXP);
+    Rcpp::traits::input_parameter< SEXP >::type securities_(securities_SEXP);
+    Rcpp::traits::input_parameter< int >::type n(nSEXP);
+    rcpp_result_gen = Rcpp::wrap(bookSnapshot_Impl(engine_, securities_, n));
+    return rcpp_result_gen;
+END_RCPP
+}
+// changeAnalytics_Impl
+SEXP changeAnalytics_Impl(SEXP engine_, const std::string action, const std::string name, SEXP securities_, const std::string type, const std::string field, const std::string sizeField, double window);
+RcppExport SEXP _Rblpapi_changeAnalytics_Impl(SEXP engine_SEXP, SEXP actionSEXP, SEXP nameSEXP, SEXP securities_SEXP, SEXP typeSEXP, SEXP fieldSEXP, SEXP sizeFieldSEXP, SEXP windowSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type engine_(engine_SEXP);
+    Rcpp::traits::input_parameter< const std::string >::type action(actionSEXP);
+    Rcpp::traits::input_parameter< const std::string >::type name(nameSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type securities_(securities_SEXP);
+    Rcpp::traits::input_parameter< const std::string >::type type(typeSEXP);
+    Rcpp::traits::input_parameter< const std::string >::type field(fieldSEXP);
+    Rcpp::traits::input_parameter< const std::string >::type sizeField(sizeFieldSEXP);
+    Rcpp::traits::input_parameter< double >::type window(windowSEXP);
+    rcpp_result_gen = Rcpp::wrap(changeAnalytics_Impl(engine_, action, name, securities_, type, field, sizeField, window));
+    return rcpp_result_gen;
+END_RCPP
+}
+// subscriptionAnalytics_Impl
+Rcpp::DataFrame subscriptionAnalytics_Impl(SEXP engine_);
+RcppExport SEXP _Rblpapi_subscriptionAnalytics_Impl(SEXP engine_SEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type engine_(engine_SEXP);
+    rcpp_result_gen = Rcpp::wrap(subscriptionAnalytics_Impl(engine_));
+    return rcpp_result_gen;
+END_RCPP
+}
+// stopSubscription_Impl
+SEXP stopSubscription_Impl(SEXP engine_);
+RcppExport SEXP _Rblpapi_stopSubscription_Impl(SEXP engine_SEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type engine_(engine_SEXP);
+    rcpp_result_gen = Rcpp::wrap(stopSubscription_Impl(engine_));
+    return rcpp_result_gen;
+END_RCPP
+}
+// subscriptionStatus_Impl
+Rcpp::List subscriptionStatus_Impl(SEXP engine_);
+RcppExport SEXP _Rblpapi_subscriptionStatus_Impl(SEXP engine_SEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type engine_(engine_SEXP);
+    rcpp_result_gen = Rcpp::wrap(subscriptionStatus_Impl(engine_));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -267,21 +785,55 @@ END_RCPP
 static const R_CallMethodDef CallEntries[] = {
     {"_Rblpapi_authenticate_Impl", (DL_FUNC) &_Rblpapi_authenticate_Impl, 5},
     {"_Rblpapi_bdh_Impl", (DL_FUNC) &_Rblpapi_bdh_Impl, 10},
+    {"_Rblpapi_bdhAsync_Impl", (DL_FUNC) &_Rblpapi_bdhAsync_Impl, 10},
     {"_Rblpapi_bdp_Impl", (DL_FUNC) &_Rblpapi_bdp_Impl, 7},
+    {"_Rblpapi_bdpAsync_Impl", (DL_FUNC) &_Rblpapi_bdpAsync_Impl, 7},
+    {"_Rblpapi_bdpPrepare_Impl", (DL_FUNC) &_Rblpapi_bdpPrepare_Impl, 6},
+    {"_Rblpapi_bdpExecute_Impl", (DL_FUNC) &_Rblpapi_bdpExecute_Impl, 2},
+    {"_Rblpapi_bdpRows_Impl", (DL_FUNC) &_Rblpapi_bdpRows_Impl, 7},
+    {"_Rblpapi_bdpBatch_Impl", (DL_FUNC) &_Rblpapi_bdpBatch_Impl, 6},
     {"_Rblpapi_bds_Impl", (DL_FUNC) &_Rblpapi_bds_Impl, 7},
     {"_Rblpapi_getPortfolio_Impl", (DL_FUNC) &_Rblpapi_getPortfolio_Impl, 7},
     {"_Rblpapi_beqs_Impl", (DL_FUNC) &_Rblpapi_beqs_Impl, 7},
-    {"_Rblpapi_blpConnect_Impl", (DL_FUNC) &_Rblpapi_blpConnect_Impl, 4},
+    {"_Rblpapi_blpConnect_Impl", (DL_FUNC) &_Rblpapi_blpConnect_Impl, 6},
+    {"_Rblpapi_blpConnectRouter_Impl", (DL_FUNC) &_Rblpapi_blpConnectRouter_Impl, 7},
     {"_Rblpapi_getHeaderVersion", (DL_FUNC) &_Rblpapi_getHeaderVersion, 0},
     {"_Rblpapi_getRuntimeVersion", (DL_FUNC) &_Rblpapi_getRuntimeVersion, 0},
     {"_Rblpapi_haveBlp", (DL_FUNC) &_Rblpapi_haveBlp, 0},
     {"_Rblpapi_bsrch_Impl", (DL_FUNC) &_Rblpapi_bsrch_Impl, 4},
+    {"_Rblpapi_blpConnectPool_Impl", (DL_FUNC) &_Rblpapi_blpConnectPool_Impl, 10},
+    {"_Rblpapi_poolStatus_Impl", (DL_FUNC) &_Rblpapi_poolStatus_Impl, 1},
+    {"_Rblpapi_requestStatus_Impl", (DL_FUNC) &_Rblpapi_requestStatus_Impl, 1},
+    {"_Rblpapi_waitRequest_Impl", (DL_FUNC) &_Rblpapi_waitRequest_Impl, 2},
+    {"_Rblpapi_cancelRequest_Impl", (DL_FUNC) &_Rblpapi_cancelRequest_Impl, 1},
+    {"_Rblpapi_collectRequest_Impl", (DL_FUNC) &_Rblpapi_collectRequest_Impl, 1},
     {"_Rblpapi_fieldSearch_Impl", (DL_FUNC) &_Rblpapi_fieldSearch_Impl, 2},
     {"_Rblpapi_getBars_Impl", (DL_FUNC) &_Rblpapi_getBars_Impl, 8},
+    {"_Rblpapi_getBarsCached_Impl", (DL_FUNC) &_Rblpapi_getBarsCached_Impl, 8},
+    {"_Rblpapi_clearBarCache_Impl", (DL_FUNC) &_Rblpapi_clearBarCache_Impl, 1},
     {"_Rblpapi_fieldInfo_Impl", (DL_FUNC) &_Rblpapi_fieldInfo_Impl, 2},
     {"_Rblpapi_getTicks_Impl", (DL_FUNC) &_Rblpapi_getTicks_Impl, 7},
+    {"_Rblpapi_getQuotedTrades_Impl", (DL_FUNC) &_Rblpapi_getQuotedTrades_Impl, 6},
     {"_Rblpapi_lookup_Impl", (DL_FUNC) &_Rblpapi_lookup_Impl, 6},
-    {"_Rblpapi_subscribe_Impl", (DL_FUNC) &_Rblpapi_subscribe_Impl, 6},
+    {"_Rblpapi_bdpMembers_Impl", (DL_FUNC) &_Rblpapi_bdpMembers_Impl, 11},
+    {"_Rblpapi_replayDepth_Impl", (DL_FUNC) &_Rblpapi_replayDepth_Impl, 8},
+    {"_Rblpapi_replayJournal_Impl", (DL_FUNC) &_Rblpapi_replayJournal_Impl, 7},
+    {"_Rblpapi_requestStatistics_Impl", (DL_FUNC) &_Rblpapi_requestStatistics_Impl, 1},
+    {"_Rblpapi_setThrottle_Impl", (DL_FUNC) &_Rblpapi_setThrottle_Impl, 9},
+    {"_Rblpapi_throttleStatus_Impl", (DL_FUNC) &_Rblpapi_throttleStatus_Impl, 2},
+    {"_Rblpapi_subscribe_Impl", (DL_FUNC) &_Rblpapi_subscribe_Impl, 12},
+    {"_Rblpapi_subscribeAsync_Impl", (DL_FUNC) &_Rblpapi_subscribeAsync_Impl, 18},
+    {"_Rblpapi_pollSubscription_Impl", (DL_FUNC) &_Rblpapi_pollSubscription_Impl, 3},
+    {"_Rblpapi_subscriptionSnapshot_Impl", (DL_FUNC) &_Rblpapi_subscriptionSnapshot_Impl, 1},
+    {"_Rblpapi_changeSubscription_Impl", (DL_FUNC) &_Rblpapi_changeSubscription_Impl, 5},
+    {"_Rblpapi_subscriptionBars_Impl", (DL_FUNC) &_Rblpapi_subscriptionBars_Impl, 8},
+    {"_Rblpapi_getSubscriptionBars_Impl", (DL_FUNC) &_Rblpapi_getSubscriptionBars_Impl, 3},
+    {"_Rblpapi_subscriptionWindow_Impl", (DL_FUNC) &_Rblpapi_subscriptionWindow_Impl, 4},
+    {"_Rblpapi_bookSnapshot_Impl", (DL_FUNC) &_Rblpapi_bookSnapshot_Impl, 3},
+    {"_Rblpapi_changeAnalytics_Impl", (DL_FUNC) &_Rblpapi_changeAnalytics_Impl, 8},
+    {"_Rblpapi_subscriptionAnalytics_Impl", (DL_FUNC) &_Rblpapi_subscriptionAnalytics_Impl, 1},
+    {"_Rblpapi_stopSubscription_Impl", (DL_FUNC) &_Rblpapi_stopSubscription_Impl, 1},
+    {"_Rblpapi_subscriptionStatus_Impl", (DL_FUNC) &_Rblpapi_subscriptionStatus_Impl, 1},
     {NULL, NULL, 0}
 };
 
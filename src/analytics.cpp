@@ -0,0 +1,209 @@
+// -*- mode: C++; c-indent-level: 4; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+//
+//  analytics.cpp -- incremental operators over subscription updates
+//
+//  Copyright (C) 2026  Whit Armstrong and Dirk Eddelbuettel
+//
+//  This file is part of Rblpapi
+//
+//  Rblpapi is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  Rblpapi is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Rblpapi.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#if defined(HaveBlp)
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <analytics.h>
+
+namespace {
+    const double NaN = std::numeric_limits<double>::quiet_NaN();
+
+    class Vwap : public StreamOperator {
+    public:
+        explicit Vwap(double window) : window(window) {}
+        void update(double time, double x, double size) override {
+            if (!(size > 0)) return;
+            q.push_back(Item{time, x * size, size});
+            value_ += x * size;
+            size_ += size;
+            evict(time);
+        }
+        double value(double now) override {
+            evict(now);
+            return size_ > 0 ? value_ / size_ : NaN;
+        }
+    private:
+        struct Item { double time, value, size; };
+        void evict(double now) {
+            while (!q.empty() && q.front().time <= now - window) {
+                value_ -= q.front().value;
+                size_ -= q.front().size;
+                q.pop_front();
+            }
+            if (q.empty()) value_ = size_ = 0.0;    // no drift from rounding
+        }
+        double window;
+        std::deque<Item> q;
+        double value_ = 0.0, size_ = 0.0;
+    };
+
+    class Ewma : public StreamOperator {
+    public:
+        explicit Ewma(double halfLife) : halfLife(halfLife) {}
+        void update(double time, double x, double) override {
+            if (std::isnan(mean)) {
+                mean = x;
+            } else {
+                const double alpha = 1.0 - std::exp(-M_LN2 * std::max(time - last, 0.0) / halfLife);
+                mean += alpha * (x - mean);
+            }
+            last = time;
+        }
+        double value(double) override { return mean; }
+    private:
+        double halfLife;
+        double mean = NaN;
+        double last = 0.0;
+    };
+
+    class Volatility : public StreamOperator {
+    public:
+        explicit Volatility(double window) : window(window) {}
+        void update(double time, double x, double) override {
+            if (!(x > 0)) return;
+            if (prev > 0) {
+                const double r = std::log(x / prev);
+                q.push_back(Item{time, r * r});
+                sum += r * r;
+            }
+            prev = x;
+            evict(time);
+        }
+        double value(double now) override {
+            evict(now);
+            return q.empty() ? NaN : std::sqrt(std::max(sum, 0.0));
+        }
+    private:
+        struct Item { double time, r2; };
+        void evict(double now) {
+            while (!q.empty() && q.front().time <= now - window) {
+                sum -= q.front().r2;
+                q.pop_front();
+            }
+            if (q.empty()) sum = 0.0;
+        }
+        double window;
+        std::deque<Item> q;
+        double sum = 0.0;
+        double prev = 0.0;
+    };
+
+    class Count : public StreamOperator {
+    public:
+        explicit Count(double window) : window(window) {}
+        void update(double time, double, double) override {
+            q.push_back(time);
+            evict(time);
+        }
+        double value(double now) override {
+            evict(now);
+            return static_cast<double>(q.size());
+        }
+    private:
+        void evict(double now) {
+            while (!q.empty() && q.front() <= now - window) q.pop_front();
+        }
+        double window;
+        std::deque<double> q;
+    };
+
+    bool number(const Update& u, size_t slot, double& x) {
+        if (slot >= u.values.size()) return false;
+        const FieldValue& v = u.values[slot];
+        if (v.isNull() || v.kind == FieldValue::String) return false;
+        x = v.num;
+        return true;
+    }
+}
+
+std::unique_ptr<StreamOperator> makeStreamOperator(const std::string& type, double window) {
+    if (!(window > 0)) throw std::invalid_argument("Operator window must be positive.");
+    if (type == "vwap") return std::unique_ptr<StreamOperator>(new Vwap(window));
+    if (type == "ewma") return std::unique_ptr<StreamOperator>(new Ewma(window));
+    if (type == "volatility") return std::unique_ptr<StreamOperator>(new Volatility(window));
+    if (type == "count") return std::unique_ptr<StreamOperator>(new Count(window));
+    throw std::invalid_argument("Unknown operator '" + type + "'.");
+}
+
+void AnalyticsRegistry::add(int topic, const std::string& name, const std::string& type,
+                            const Input& input, double window) {
+    entries.push_back(Entry{topic, name, type, input, makeStreamOperator(type, window), NaN, NaN, NaN, 0});
+    reindex();
+}
+
+void AnalyticsRegistry::remove(const std::string& name) {
+    std::vector<Entry> kept;
+    for (auto& e : entries) {
+        if (e.name != name) kept.push_back(std::move(e));
+    }
+    entries.swap(kept);
+    reindex();
+}
+
+bool AnalyticsRegistry::contains(const std::string& name) const {
+    for (const auto& e : entries) {
+        if (e.name == name) return true;
+    }
+    return false;
+}
+
+void AnalyticsRegistry::reindex() {
+    byTopic.clear();
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const size_t t = static_cast<size_t>(entries[i].topic);
+        if (byTopic.size() <= t) byTopic.resize(t + 1);
+        byTopic[t].push_back(i);
+    }
+}
+
+void AnalyticsRegistry::update(const Update& u) {
+    if (u.topic < 0 || static_cast<size_t>(u.topic) >= byTopic.size()) return;
+    for (size_t i : byTopic[u.topic]) {
+        Entry& e = entries[i];
+        double x, size = 0.0;
+        if (e.input.mid) {
+            bool seen = false;
+            if (number(u, e.input.slot, x)) { e.bid = x; seen = true; }
+            if (number(u, e.input.askSlot, x)) { e.ask = x; seen = true; }
+            if (!seen || std::isnan(e.bid) || std::isnan(e.ask)) continue;
+            x = 0.5 * (e.bid + e.ask);
+        } else if (!number(u, e.input.slot, x)) {
+            continue;
+        }
+        if (e.input.sized && !number(u, e.input.sizeSlot, size)) continue;
+        e.op->update(u.received, x, size);
+        e.time = u.received;
+        ++e.count;
+    }
+}
+
+void AnalyticsRegistry::outputs(double now, std::vector<Output>& out) {
+    for (auto& e : entries) {
+        out.push_back(Output{e.topic, e.name, e.type, e.op->value(now), e.time, e.count});
+    }
+}
+
+#endif
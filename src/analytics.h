@@ -0,0 +1,91 @@
+// -*- mode: C++; c-indent-level: 4; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+//
+//  analytics.h -- incremental operators over subscription updates
+//
+//  Copyright (C) 2026  Whit Armstrong and Dirk Eddelbuettel
+//
+//  This file is part of Rblpapi
+//
+//  Rblpapi is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  Rblpapi is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Rblpapi.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include <subscription.h>
+
+// Operator over the successive values of one input, updated in amortised
+// constant time per value. Windows are in seconds of receive time; values
+// leaving the window are evicted lazily, on update or when read.
+class StreamOperator {
+public:
+    virtual ~StreamOperator() {}
+    virtual void update(double time, double x, double size) = 0;
+    virtual double value(double now) = 0;
+};
+
+// one of "vwap", "ewma" (window is the half-life), "volatility" (square root of
+// the sum of squared log returns) or "count"; throws std::invalid_argument
+std::unique_ptr<StreamOperator> makeStreamOperator(const std::string& type, double window);
+
+// Operators attached to topics, fed with every decoded update of their topic.
+// An input is a field slot, or the mid of a bid and an ask slot; operators
+// weighting by size take a second slot. Inputs not present in an update leave
+// the operator untouched, except that the mid uses the last bid and ask seen.
+class AnalyticsRegistry {
+public:
+    struct Input {
+        size_t slot;
+        size_t askSlot = 0;             // with mid only
+        size_t sizeSlot = 0;            // with sized only
+        bool mid = false;
+        bool sized = false;
+    };
+    struct Output {
+        int topic;
+        std::string name;
+        std::string type;
+        double value;
+        double time;                    // of the last input
+        uint64_t count;                 // inputs seen
+    };
+
+    void add(int topic, const std::string& name, const std::string& type, const Input& input, double window);
+    void remove(const std::string& name);
+    bool contains(const std::string& name) const;
+    void update(const Update& u);
+    void outputs(double now, std::vector<Output>& out);
+    size_t size() const { return entries.size(); }
+
+private:
+    struct Entry {
+        int topic;
+        std::string name;
+        std::string type;
+        Input input;
+        std::unique_ptr<StreamOperator> op;
+        double bid, ask;
+        double time;
+        uint64_t count;
+    };
+    void reindex();
+
+    std::vector<Entry> entries;
+    std::vector<std::vector<size_t>> byTopic;
+};
@@ -0,0 +1,90 @@
+// -*- mode: C++; c-indent-level: 4; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+//
+//  barbuilder.cpp -- intraday bars rolled forward from streamed trades
+//
+//  Copyright (C) 2026  Whit Armstrong and Dirk Eddelbuettel
+//
+//  This file is part of Rblpapi
+//
+//  Rblpapi is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  Rblpapi is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Rblpapi.  If not, see <http://www.gnu.org/licenses/>.
+
+#if defined(HaveBlp)
+
+#include <algorithm>
+#include <cmath>
+#include <bars.h>
+
+BarBuilder::BarBuilder(int barInterval, size_t capacity)
+    : width(barInterval * 60.0), ring(std::max<size_t>(capacity, 1)) {
+}
+
+void BarBuilder::complete() {
+    ring[head] = open;
+    head = (head + 1) % ring.size();
+    if (count < ring.size()) ++count;
+    isOpen = false;
+}
+
+void BarBuilder::seed(const Bars& history) {
+    for (size_t i = 0; i < history.size(); ++i) {
+        const Bar b{history.time[i], history.open[i], history.high[i], history.low[i], history.close[i],
+                    history.numEvents[i], history.volume[i], history.value[i]};
+        if (isOpen) {
+            if (b.time <= open.time) continue;  // out of order or already streamed
+            complete();
+        }
+        open = b;
+        isOpen = true;
+    }
+}
+
+void BarBuilder::trade(double time, double price, double size) {
+    if (std::isnan(price)) return;
+    if (std::isnan(size)) size = 0.0;
+    const double start = std::floor(time / width) * width;
+    if (isOpen) {
+        if (start < open.time) return;  // late trade for a completed bar
+        if (start == open.time) {
+            open.high = std::max(open.high, price);
+            open.low = std::min(open.low, price);
+            open.close = price;
+            open.numEvents += 1;
+            open.volume += size;
+            open.value += price * size;
+            return;
+        }
+        complete();
+    }
+    open = Bar{start, price, price, price, price, 1, size, price * size};
+    isOpen = true;
+}
+
+void BarBuilder::roll(double now) {
+    if (isOpen && now >= open.time + width) complete();
+}
+
+void BarBuilder::completed(Bars& out, size_t n) const {
+    if (n == 0 || n > count) n = count;
+    for (size_t k = 0; k < n; ++k) {
+        const Bar& b = ring[(head + ring.size() - n + k) % ring.size()];
+        out.push_back(b.time, b.open, b.high, b.low, b.close, b.numEvents, b.volume, b.value);
+    }
+}
+
+bool BarBuilder::current(Bar& bar) const {
+    if (isOpen) bar = open;
+    return isOpen;
+}
+
+#endif
@@ -0,0 +1,125 @@
+// -*- mode: C++; c-indent-level: 4; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+//
+//  barcache.cpp -- local store of intraday bars with gap tracking
+//
+//  Copyright (C) 2026  Whit Armstrong and Dirk Eddelbuettel
+//
+//  This file is part of Rblpapi
+//
+//  Rblpapi is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  Rblpapi is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Rblpapi.  If not, see <http://www.gnu.org/licenses/>.
+
+#if defined(HaveBlp)
+
+#include <algorithm>
+#include <cmath>
+#include <bars.h>
+
+void aggregateBars(const Bars& fine, const int barInterval, Bars& coarse) {
+    const double width = barInterval * 60.0;
+    for (size_t i = 0; i < fine.size(); ++i) {
+        double start = std::floor(fine.time[i] / width) * width;
+        if (coarse.size() == 0 || coarse.time.back() != start) {
+            coarse.push_back(start, fine.open[i], fine.high[i], fine.low[i], fine.close[i],
+                             fine.numEvents[i], fine.volume[i], fine.value[i]);
+        } else {
+            size_t j = coarse.size() - 1;
+            coarse.high[j] = std::max(coarse.high[j], fine.high[i]);
+            coarse.low[j] = std::min(coarse.low[j], fine.low[i]);
+            coarse.close[j] = fine.close[i];
+            coarse.numEvents[j] += fine.numEvents[i];
+            coarse.volume[j] += fine.volume[i];
+            coarse.value[j] += fine.value[i];
+        }
+    }
+}
+
+void BarSeries::insert(const Bars& b) {
+    for (size_t i = 0; i < b.size(); ++i) {
+        bars[b.time[i]] = Bar{b.time[i], b.open[i], b.high[i], b.low[i], b.close[i],
+                              b.numEvents[i], b.volume[i], b.value[i]};
+    }
+}
+
+void BarSeries::markCovered(double start, double end) {
+    if (end <= start) return;
+    std::vector<std::pair<double,double>> merged;
+    bool placed = false;
+    for (const auto& r : covered) {
+        if (r.second < start) {                 // strictly before, keep
+            merged.push_back(r);
+        } else if (r.first > end) {             // strictly after, keep but insert ours first
+            if (!placed) { merged.emplace_back(start, end); placed = true; }
+            merged.push_back(r);
+        } else {                                // overlapping or adjacent, absorb
+            start = std::min(start, r.first);
+            end = std::max(end, r.second);
+        }
+    }
+    if (!placed) merged.emplace_back(start, end);
+    covered.swap(merged);
+}
+
+bool BarSeries::covers(double start, double end) const {
+    for (const auto& r : covered) {
+        if (r.first <= start && end <= r.second) return true;
+    }
+    return false;
+}
+
+std::vector<std::pair<double,double>> BarSeries::gaps(double start, double end) const {
+    std::vector<std::pair<double,double>> ans;
+    double cur = start;
+    for (const auto& r : covered) {
+        if (r.second <= cur) continue;
+        if (r.first >= end) break;
+        if (r.first > cur) ans.emplace_back(cur, r.first);
+        cur = std::max(cur, r.second);
+        if (cur >= end) break;
+    }
+    if (cur < end) ans.emplace_back(cur, end);
+    return ans;
+}
+
+void BarSeries::extract(double start, double end, Bars& b) const {
+    for (auto it = bars.lower_bound(start); it != bars.end() && it->first < end; ++it) {
+        const Bar& x = it->second;
+        b.push_back(x.time, x.open, x.high, x.low, x.close, x.numEvents, x.volume, x.value);
+    }
+}
+
+const BarSeries* BarCache::finerSeries(const BarKey& key, double start, double end, int& interval) const {
+    const BarSeries* ans = nullptr;
+    BarKey first{key.security, key.eventType, key.options, 0};
+    for (auto it = cache.lower_bound(first); it != cache.end() && it->first.interval < key.interval; ++it) {
+        const BarKey& k = it->first;
+        if (k.security != key.security || k.eventType != key.eventType || k.options != key.options) break;
+        if (key.interval % k.interval == 0 && it->second.covers(start, end)) {
+            ans = &it->second;              // keys are ordered by interval, so keep the coarsest
+            interval = k.interval;
+        }
+    }
+    return ans;
+}
+
+void BarCache::clear(const std::string& security) {
+    for (auto it = cache.begin(); it != cache.end(); ) {
+        if (it->first.security == security) {
+            it = cache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,148 @@
+// -*- mode: C++; c-indent-level: 4; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+//
+//  bars.h -- intraday bar containers, a local bar cache and rolling bars
+//
+//  Copyright (C) 2026  Whit Armstrong and Dirk Eddelbuettel
+//
+//  This file is part of Rblpapi
+//
+//  Rblpapi is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  Rblpapi is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Rblpapi.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <vector>
+#include <map>
+#include <string>
+#include <utility>
+
+// column store of bars as returned by an IntradayBarRequest
+struct Bars {
+    std::vector<double> time;     // to be converted to POSIXct later
+    std::vector<double> open;
+    std::vector<double> high;
+    std::vector<double> low;
+    std::vector<double> close;
+    std::vector<int> numEvents;
+    std::vector<double> volume;   // instread of long long
+    std::vector<double> value;   // instread of long long
+
+    void push_back(double t, double o, double h, double l, double c, int n, double vol, double val) {
+        time.push_back(t); open.push_back(o); high.push_back(h); low.push_back(l);
+        close.push_back(c); numEvents.push_back(n); volume.push_back(vol); value.push_back(val);
+    }
+    size_t size() const { return time.size(); }
+};
+
+// a single bar, time is the opening time of the bar in seconds since the epoch (UTC)
+struct Bar {
+    double time, open, high, low, close;
+    int numEvents;
+    double volume, value;
+};
+
+// aggregate bars into bars of barInterval minutes, aligned on multiples of
+// the interval since the epoch; input is assumed to be sorted by time
+void aggregateBars(const Bars& fine, const int barInterval, Bars& coarse);
+
+// all bars known for one cache key along with the time ranges [start, end)
+// for which the set of bars is known to be complete
+class BarSeries {
+public:
+    void insert(const Bars& bars);
+    void markCovered(double start, double end);
+    bool covers(double start, double end) const;
+    std::vector<std::pair<double,double>> gaps(double start, double end) const;
+    void extract(double start, double end, Bars& bars) const;
+    size_t size() const { return bars.size(); }
+
+private:
+    std::map<double, Bar> bars;
+    std::vector<std::pair<double,double>> covered;	// sorted and non-overlapping
+};
+
+struct BarKey {
+    std::string security;
+    std::string eventType;
+    std::string options;        // canonical 'name=value,...' form of the request options
+    int interval;
+
+    bool operator<(const BarKey& other) const {
+        if (security != other.security) return security < other.security;
+        if (eventType != other.eventType) return eventType < other.eventType;
+        if (options != other.options) return options < other.options;
+        return interval < other.interval;
+    }
+};
+
+class BarCache {
+public:
+    BarSeries& series(const BarKey& key) { return cache[key]; }
+
+    // coarsest cached series for the same security, event type and options
+    // whose interval divides key.interval and which covers [start, end)
+    const BarSeries* finerSeries(const BarKey& key, double start, double end, int& interval) const;
+
+    void clear() { cache.clear(); }
+    void clear(const std::string& security);
+
+private:
+    std::map<BarKey, BarSeries> cache;
+};
+
+// Rolling bars of one security: seeded once from history, then advanced trade
+// by trade. Completed bars are kept in a ring of fixed capacity which drops
+// the oldest bar once full; intervals without trades yield no bar, as with
+// IntradayBarRequest.
+class BarBuilder {
+public:
+    BarBuilder(int barInterval, size_t capacity);
+
+    // history sorted by time; its last bar is taken as the one in progress
+    void seed(const Bars& history);
+    void trade(double time, double price, double size);
+    // complete the bar in progress once its interval has passed by 'now'
+    void roll(double now);
+
+    // the last n (all if zero) completed bars, oldest first
+    void completed(Bars& out, size_t n) const;
+    bool current(Bar& bar) const;
+    size_t size() const { return count; }
+
+private:
+    void complete();
+
+    double width;
+    std::vector<Bar> ring;
+    size_t head = 0;                    // next slot to write
+    size_t count = 0;
+    Bar open;
+    bool isOpen = false;
+};
+
+#if defined(HaveBlp)
+#include <memory>
+#include <Rcpp.h>
+#include <requestengine.h>
+
+// IntradayBarRequest through the engine of a connection, see getBars.cpp;
+// sent at once and collected later so that several can be in flight
+std::shared_ptr<BufferedRequestState> sendBarRequest(ConnectionEngine& engine, const std::string& security,
+                                                     const std::string& eventType, const int barInterval,
+                                                     const std::string& startDateTime, const std::string& endDateTime,
+                                                     SEXP options, const bool verbose);
+// returns false if a response carried an error, the bars then being incomplete
+bool collectBars(ConnectionEngine& engine, const std::shared_ptr<BufferedRequestState>& state,
+                 const int barInterval, const bool verbose, Bars& bars);
+std::string posixToRequestString(const double t);
+#endif
@@ -20,6 +20,9 @@
 //  along with Rblpapi.  If not, see <http://www.gnu.org/licenses/>.
 
 #if defined(HaveBlp)
+#include <memory>
+#include <sstream>
+#include <stdexcept>
 #include <vector>
 #include <string>
 #include <blpapi_session.h>
@@ -29,63 +32,125 @@
 #include <blpapi_message.h>
 #include <blpapi_element.h>
 #include <blpapi_utils.h>
+#include <eventrouter.h>
 
-using BloombergLP::blpapi::Session;
 using BloombergLP::blpapi::Service;
 using BloombergLP::blpapi::Request;
-using BloombergLP::blpapi::Event;
 using BloombergLP::blpapi::Element;
+using BloombergLP::blpapi::Identity;
 using BloombergLP::blpapi::Message;
-using BloombergLP::blpapi::MessageIterator;
 using BloombergLP::blpapi::Name;
 
-std::string getSecurityName(Event& event) {
-    MessageIterator msgIter(event);
-    if (!msgIter.next()) {
-        Rcpp::stop("Not a valid MessageIterator.");
+// one data.frame per security, decoded as the responses arrive and
+// materialised on the R thread
+class HistDataState : public TypedRequestState {
+public:
+    HistDataState(const std::vector<std::string>& fields, const Service& fieldService, Request* request,
+                  bool relativeDate, bool int_as_double, bool verbose)
+        : TypedRequestState(fields, fieldService, request), fields(fields),
+          relativeDate(relativeDate), int_as_double(int_as_double), verbose(verbose) {}
+
+    SEXP materialize() override {
+        if (verbose) Rcpp::Rcout << log.str();
+        Rcpp::List ans(frames.size());
+        std::vector<std::string> ans_names;
+        for (size_t k = 0; k < frames.size(); ++k) {
+            const Frame& f = frames[k];
+            Rcpp::List res(allocateDataFrame(f.nrow, fields, rtypes));
+            for (size_t j = 0; j < fields.size(); ++j) {
+                SEXP col = res[j];
+                for (size_t i = 0; i < f.nrow; ++i) {
+                    setDfCell(col, i, f.cells[i * fields.size() + j]);
+                }
+            }
+            ans[k] = res;
+            ans_names.push_back(f.security);
+        }
+        ans.attr("names") = ans_names;
+        return ans;
     }
 
-    Message msg = msgIter.message();
-    Element response = msg.asElement();
-    if(std::strcmp(response.name().string(),"HistoricalDataResponse")) {
-        Rcpp::stop("Not a valid HistoricalDataResponse.");
+protected:
+    void typesResolved(const std::vector<RblpapiT>& types) override {
+        rtypes = types;
+        // for bdh request all int fields as doubles b/c of implicit bbg conversion
+        if (int_as_double) {
+            std::transform(rtypes.begin(), rtypes.end(), rtypes.begin(),
+                           [](RblpapiT x) { return x == RblpapiT::Integer || x == RblpapiT::Integer64 ? RblpapiT::Double : x; });
+        }
+        // in case of option returnRelativeDate=TRUE we need to add a field
+        if (relativeDate) {
+            fields.insert(fields.begin(),"RELATIVE_DATE");
+            rtypes.insert(rtypes.begin(),RblpapiT::String);
+        }
+        // the date field was not part of the request but we need to map it
+        // into the result, we always want it in the first position
+        fields.insert(fields.begin(),"date");
+        rtypes.insert(rtypes.begin(),RblpapiT::Date);
     }
 
-    Element securityData = response.getElement(Name{"securityData"});
-    std::string ans(securityData.getElementAsString(Name{"security"}));
-    return ans;
-}
-
-Rcpp::List HistoricalDataResponseToDF(Event& event, const std::vector<std::string>& fields,
-                                      const std::vector<RblpapiT>& rtypes, bool verbose=FALSE) {
-    MessageIterator msgIter(event);
-    if (!msgIter.next()) {
-        Rcpp::stop("Not a valid MessageIterator.");
+    void decodeData(const Message& msg) override {
+        Element response = msg.asElement();
+        if (verbose) response.print(log);
+        if (std::strcmp(response.name().string(),"HistoricalDataResponse")) {
+            throw std::runtime_error("Not a valid HistoricalDataResponse.");
+        }
+        Element securityData = response.getElement(Name{"securityData"});
+        Element fieldData = securityData.getElement(Name{"fieldData"});
+        frames.emplace_back();
+        Frame& f = frames.back();
+        f.security = securityData.getElementAsString(Name{"security"});
+        f.nrow = fieldData.numValues();
+        f.cells.resize(f.nrow * fields.size());
+        for(size_t i = 0; i < fieldData.numValues(); i++) {
+            Element row = fieldData.getValueAsElement(i);
+            for(size_t j = 0; j < row.numElements(); ++j) {
+                Element e = row.getElement(j);
+                auto it = std::find(fields.begin(),fields.end(),e.name().string());
+                if(it==fields.end()) { throw std::runtime_error("Unexpected field returned."); }
+                int colindex = std::distance(fields.begin(),it);
+                f.cells[i * fields.size() + colindex] = elementToCell(e, rtypes[colindex]);
+            }
+        }
     }
 
-    Message msg = msgIter.message();
-    Element response = msg.asElement();
-    if (verbose) response.print(Rcpp::Rcout);
-    if (std::strcmp(response.name().string(),"HistoricalDataResponse")) {
-        Rcpp::stop("Not a valid HistoricalDataResponse.");
+private:
+    struct Frame {
+        std::string security;
+        size_t nrow;
+        std::vector<FieldValue> cells;  // row-major
+    };
+    std::vector<std::string> fields;
+    std::vector<RblpapiT> rtypes;
+    bool relativeDate, int_as_double, verbose;
+    std::vector<Frame> frames;          // in the order the securities arrive
+    std::ostringstream log;
+};
+
+// send a bdh without waiting for it
+std::shared_ptr<RequestState> bdhSubmit(RequestEngine& engine, const std::vector<std::string>& securities,
+                                        const std::vector<std::string>& fields,
+                                        const std::string& start_date_, SEXP end_date_,
+                                        SEXP options_, SEXP overrides_, bool verbose, const Identity* identity,
+                                        bool int_as_double) {
+    bool relativeDate = false;
+    if(options_ != R_NilValue) {
+      Rcpp::CharacterVector options(options_);
+      if (options.containsElementNamed("returnRelativeDate")) {
+        relativeDate = options[options.findName("returnRelativeDate")] == "TRUE";
+      }
     }
-    Element securityData = response.getElement(Name{"securityData"});
-    Element fieldData = securityData.getElement(Name{"fieldData"});
-
-    Rcpp::List res(allocateDataFrame(fieldData.numValues(), fields, rtypes));
-
-    // i is the row iterator
-    for(size_t i = 0; i < fieldData.numValues(); i++) {
-        Element row = fieldData.getValueAsElement(i);
-        for(size_t j = 0; j < row.numElements(); ++j) {
-            Element e = row.getElement(j);
-            auto it = std::find(fields.begin(),fields.end(),e.name().string());
-            if(it==fields.end()) { Rcpp::stop("Unexpected field returned."); }
-            int colindex = std::distance(fields.begin(),it);
-            populateDfRow(res[colindex], i, e, rtypes[colindex]);
-        }
+    Service fieldService = engine.service("//blp/apiflds");
+    Request* request = new Request(engine.service("//blp/refdata").createRequest("HistoricalDataRequest"));
+    auto state = std::make_shared<HistDataState>(fields, fieldService, request, relativeDate,
+                                                 int_as_double, verbose);
+    createStandardRequest(*request, securities, fields, options_, overrides_);
+    request->set(Name{"startDate"}, start_date_.c_str());
+    if (end_date_ != R_NilValue) {
+        request->set(Name{"endDate"}, Rcpp::as<std::string>(end_date_).c_str());
     }
-    return res;
+    state->start(engine, identity);
+    return state;
 }
 #else
 #include <Rcpp/Lightest>
@@ -103,97 +168,30 @@ Rcpp::List bdh_Impl(SEXP con_,
 
 #if defined(HaveBlp)
 
-    Session* session =
-        reinterpret_cast<Session*>(checkExternalPointer(con_,"blpapi::Session*"));
-
-
-    // get the field info
-    std::vector<FieldInfo> fldinfos(getFieldTypes(session, fields));
-    std::vector<RblpapiT> rtypes;
-    for(auto f : fldinfos) {
-        rtypes.push_back(fieldInfoToRblpapiT(f.datatype,f.ftype));
-    }
-
-    // for bdh request all int fields as doubles b/c of implicit bbg conversion
-    if (int_as_double) {
-      std::transform(rtypes.begin(), rtypes.end(), rtypes.begin(),
-                     [](RblpapiT x) { return x == RblpapiT::Integer || x == RblpapiT::Integer64 ? RblpapiT::Double : x; });
-    }
-
-    const std::string rdsrv = "//blp/refdata";
-    if (!session->openService(rdsrv.c_str())) {
-        Rcpp::stop("Failed to open " + rdsrv);
-    }
-
-    Service refDataService = session->getService(rdsrv.c_str());
-    Request request = refDataService.createRequest("HistoricalDataRequest");
-    createStandardRequest(request, securities, fields, options_, overrides_);
+    ConnectionEngine engine(con_, securities);
+    auto state = bdhSubmit(*engine, securities, fields, start_date_, end_date_, options_, overrides_,
+                           verbose, engine.identity(identity_), int_as_double);
+    engine->await(state);
+    return state->materialize();
 
-    request.set(Name{"startDate"}, start_date_.c_str());
-    if (end_date_ != R_NilValue) {
-        request.set(Name{"endDate"}, Rcpp::as<std::string>(end_date_).c_str());
-    }
-
-    sendRequestWithIdentity(session, request, identity_);
-
-    Rcpp::List ans(securities.size());
-    R_len_t i = 0;
-
-    // capture names in case they come back out of order
-    std::vector<std::string> ans_names;
-
-    // in case of option returnRelativeDate=TRUE
-    // we need to add a field
-    if(options_ != R_NilValue) {
-      Rcpp::CharacterVector options(options_);
-      if (options.containsElementNamed("returnRelativeDate")) {
-        R_len_t ni = options.findName("returnRelativeDate");
-        if (options[ni] == "TRUE") {
-          fields.insert(fields.begin(),"RELATIVE_DATE");
-          rtypes.insert(rtypes.begin(),RblpapiT::String);
-        }
-      }
-    }
-
-    // the date field was not part of the request
-    // but we need to map it into the result
-    // we always want it in the first position
-    fields.insert(fields.begin(),"date");
-    rtypes.insert(rtypes.begin(),RblpapiT::Date);
+#else // ie no Blp
+    return Rcpp::List();
+#endif
+}
 
-    while (true) {
-        Event event = session->nextEvent();
-        switch (event.eventType()) {
-        case Event::RESPONSE:
-        case Event::PARTIAL_RESPONSE:
-            ans_names.push_back(getSecurityName(event));
-            ans[i++] = HistoricalDataResponseToDF(event, fields, rtypes, verbose);
-            break;
-        case Event::REQUEST_STATUS: {
-            MessageIterator msgIter(event);
-            while (msgIter.next()) {
-                Message msg = msgIter.message();
-                Element response = msg.asElement();
-                if (verbose) response.print(Rcpp::Rcout);
-                // FIXME:: capture msg here for logging
-            }
-            Rcpp::stop("Bloomberg request timed out on server side\n");
-            break;
-        }
-        default: {
-            MessageIterator msgIter(event);
-            while (msgIter.next()) {
-                Message msg = msgIter.message();
-                // FIXME:: capture msg here for logging
-            }
-        }
-        }
-        if (event.eventType() == Event::RESPONSE) { break; }
+// [[Rcpp::export]]
+SEXP bdhAsync_Impl(SEXP con_, std::vector<std::string> securities, std::vector<std::string> fields,
+                   std::string start_date_, SEXP end_date_, SEXP options_, SEXP overrides_,
+                   bool verbose, SEXP identity_, bool int_as_double) {
+#if defined(HaveBlp)
+    ConnectionEngine engine(con_, securities);
+    if (!engine.routed()) {
+        Rcpp::stop("Asynchronous requests need a connection with dispatcher threads.");
     }
-    ans.attr("names") = ans_names;
-    return ans;
-
+    return createRequestHandle(con_, *engine, bdhSubmit(*engine, securities, fields, start_date_, end_date_,
+                                               options_, overrides_, verbose, engine.identity(identity_),
+                                               int_as_double));
 #else // ie no Blp
-    return Rcpp::List();
+    return R_NilValue;
 #endif
 }
@@ -22,6 +22,11 @@
 #if defined(HaveBlp)
 // compare to RefDataExample.cpp
 #include <iostream>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <sstream>
+#include <stdexcept>
 #include <vector>
 #include <string>
 #include <blpapi_session.h>
@@ -31,59 +36,225 @@
 #include <blpapi_message.h>
 #include <blpapi_element.h>
 #include <blpapi_utils.h>
+#include <eventrouter.h>
+#include <finalizers.h>
+#include <refdata.h>
 
-using BloombergLP::blpapi::Session;
 using BloombergLP::blpapi::Service;
 using BloombergLP::blpapi::Request;
-using BloombergLP::blpapi::Event;
 using BloombergLP::blpapi::Element;
+using BloombergLP::blpapi::Identity;
 using BloombergLP::blpapi::Message;
-using BloombergLP::blpapi::MessageIterator;
 using BloombergLP::blpapi::Name;
 
-void getBDPResult(Event& event, Rcpp::List& res, const std::vector<std::string>& securities, const std::vector<std::string>& colnames, const std::vector<RblpapiT>& rtypes, bool verbose) {
-    MessageIterator msgIter(event);
-    if (!msgIter.next()) {
-        Rcpp::stop("Not a valid MessageIterator.");
+namespace {
+    const Name SECURITIES("securities");
+    const Name FIELDS("fields");
+    const Name OVERRIDES("overrides");
+    const Name FIELD_ID("fieldId");
+    const Name VALUE("value");
+    const Name RESPONSE_ERROR("responseError");
+    const Name MESSAGE("message");
+    const Name SECURITY_DATA("securityData");
+    const Name SEQUENCE_NUMBER("sequenceNumber");
+    const Name SECURITY("security");
+    const Name FIELD_DATA("fieldData");
+
+    std::vector<std::pair<std::string, std::string>> namedStrings(SEXP x_, const std::string& what) {
+        std::vector<std::pair<std::string, std::string>> res;
+        if (x_ == R_NilValue) return res;
+        Rcpp::CharacterVector x(x_);
+        if (!x.hasAttribute("names") || x.attr("names") == R_NilValue) {
+            Rcpp::stop("Request " + what + " must be named.");
+        }
+        Rcpp::CharacterVector names(x.attr("names"));
+        for (R_len_t i = 0; i < x.length(); i++) {
+            res.emplace_back(static_cast<std::string>(names[i]), static_cast<std::string>(x[i]));
+        }
+        return res;
+    }
+}
+
+RefDataLayout::RefDataLayout(const std::vector<std::string>& fields, SEXP options_, SEXP overrides_)
+    : fields(fields), overrides(namedStrings(overrides_, "overrides")) {
+    for (size_t j = 0; j < fields.size(); ++j) {
+        columns.emplace(fields[j], j);
     }
-    Message msg = msgIter.message();
+    for (const auto& o : namedStrings(options_, "options")) {
+        options.emplace_back(Name(o.first.c_str()), o.second);
+    }
+}
+
+RefDataLayout::RefDataLayout(const RefDataLayout& base,
+                             const std::vector<std::pair<std::string, std::string>>& overrides)
+    : fields(base.fields), columns(base.columns), options(base.options), overrides(overrides),
+      rtypes(base.rtypes) {
+}
+
+RefDataLayout::RefDataLayout(const RefDataLayout& base, const std::vector<std::string>& fields,
+                             const std::vector<RblpapiT>& rtypes)
+    : fields(fields), options(base.options), overrides(base.overrides), rtypes(rtypes) {
+    for (size_t j = 0; j < fields.size(); ++j) {
+        columns.emplace(fields[j], j);
+    }
+}
+
+void RefDataLayout::fill(Request& request, const std::vector<std::string>& securities) const {
+    Element s = request.getElement(SECURITIES);
+    for (const auto& security : securities) s.appendValue(security.c_str());
+    Element f = request.getElement(FIELDS);
+    for (const auto& field : fields) f.appendValue(field.c_str());
+    for (const auto& o : options) request.set(o.first, o.second.c_str());
+    if (overrides.empty()) return;
+    Element requestOverrides = request.getElement(OVERRIDES);
+    for (const auto& o : overrides) {
+        Element e = requestOverrides.appendElement();
+        e.setElement(FIELD_ID, o.first.c_str());
+        e.setElement(VALUE, o.second.c_str());
+    }
+}
+
+RefDataState::RefDataState(const std::vector<std::string>& securities, std::shared_ptr<const RefDataLayout> layout,
+                           const Service& fieldService, Request* request, bool verbose)
+    : TypedRequestState(layout->fields, fieldService, request),
+      securities(securities), layout(layout), verbose(verbose),
+      cells(securities.size() * layout->fields.size()) {
+}
+
+RefDataState::RefDataState(const std::vector<std::string>& securities, std::shared_ptr<const RefDataLayout> layout,
+                           Request* request, bool verbose)
+    : TypedRequestState(layout->rtypes, request),
+      securities(securities), layout(layout), verbose(verbose),
+      cells(securities.size() * layout->fields.size()) {
+}
+
+SEXP RefDataState::materialize() {
+    Rcpp::List res(allocateDataFrame(securities, layout->fields, rtypes));
+    fillInto(res, std::vector<size_t>());
+    return res;
+}
+
+void RefDataState::fillInto(Rcpp::List& res, const std::vector<size_t>& rows) {
+    if (verbose) Rcpp::Rcout << log.str();
+    const size_t ncol = layout->fields.size();
+    for (size_t j = 0; j < ncol; ++j) {
+        SEXP col = res[j];
+        for (size_t i = 0; i < securities.size(); ++i) {
+            setDfCell(col, rows.empty() ? i : rows[i], cells[i * ncol + j]);
+        }
+    }
+}
+
+void RefDataState::decodeData(const Message& msg) {
     Element response = msg.asElement();
-    if (verbose) response.print(Rcpp::Rcout);
+    if (verbose) response.print(log);
     if (std::strcmp(response.name().string(),"ReferenceDataResponse")) {
-        Rcpp::stop("Not a valid ReferenceDataResponse.");
+        throw std::runtime_error("Not a valid ReferenceDataResponse.");
     }
-
-    const Name responseError("responseError");
-    if (response.hasElement(responseError)) {
-        Element errorElement = msg.getElement(responseError);
+    if (response.hasElement(RESPONSE_ERROR)) {
+        Element errorElement = msg.getElement(RESPONSE_ERROR);
         std::string errMsg("");
-        const Name messageTag("message");
-        if (errorElement.hasElement(messageTag)) {
-            errMsg = errorElement.getElementAsString(messageTag);
+        if (errorElement.hasElement(MESSAGE)) {
+            errMsg = errorElement.getElementAsString(MESSAGE);
         }
-        Rcpp::Rcerr << "REQUEST FAILED: " <<  errorElement << std::endl;
-        Rcpp::stop("bdp result: a responseError was received with message: (" + errMsg + ")");
+        throw std::runtime_error("bdp result: a responseError was received with message: (" + errMsg + ")");
     }
-
-    Element securityData = response.getElement(Name{"securityData"});
-
+    const size_t ncol = layout->fields.size();
+    Element securityData = response.getElement(SECURITY_DATA);
     for (size_t i = 0; i < securityData.numValues(); ++i) {
         Element this_security = securityData.getValueAsElement(i);
-        size_t row_index = this_security.getElement(Name{"sequenceNumber"}).getValueAsInt32();
-
-        // check that the seqNum matches the order of the securities vector (it's a grave error to screw this up)
-        if(securities[row_index].compare(this_security.getElementAsString(Name{"security"}))!=0) {
-            Rcpp::stop("mismatched Security sequence, please report a bug.");
+        size_t row_index = this_security.getElement(SEQUENCE_NUMBER).getValueAsInt32();
+        if (row_index >= securities.size() ||
+            securities[row_index].compare(this_security.getElementAsString(SECURITY))!=0) {
+            throw std::runtime_error("mismatched Security sequence, please report a bug.");
         }
-        Element fieldData = this_security.getElement(Name{"fieldData"});
+        Element fieldData = this_security.getElement(FIELD_DATA);
         for(size_t j = 0; j < fieldData.numElements(); ++j) {
             Element e = fieldData.getElement(j);
-            auto col_iter = std::find(colnames.begin(), colnames.end(), e.name().string());
-            if (col_iter == colnames.end()) {
-                Rcpp::stop(std::string("column is not expected: ") + e.name().string());
+            auto col = layout->columns.find(e.name().string());
+            if (col == layout->columns.end()) {
+                throw std::runtime_error(std::string("column is not expected: ") + e.name().string());
             }
-            size_t col_index = std::distance(colnames.begin(),col_iter);
-            populateDfRow(res[col_index],row_index,e,rtypes[col_index]);
+            cells[row_index * ncol + col->second] = elementToCell(e, rtypes[col->second]);
+        }
+    }
+}
+
+std::shared_ptr<RequestState> bdpSubmit(RequestEngine& engine, const std::vector<std::string>& securities,
+                                        std::shared_ptr<const RefDataLayout> layout, bool verbose,
+                                        const Identity* identity) {
+    Request* request = new Request(engine.service("//blp/refdata").createRequest("ReferenceDataRequest"));
+    std::shared_ptr<RefDataState> state;
+    if (layout->rtypes.empty()) {
+        state = std::make_shared<RefDataState>(securities, layout, engine.service("//blp/apiflds"), request, verbose);
+    } else {
+        state = std::make_shared<RefDataState>(securities, layout, request, verbose);
+    }
+    layout->fill(*request, securities);
+    state->start(engine, identity);
+    return state;
+}
+
+std::shared_ptr<RequestState> bdpSubmit(RequestEngine& engine, const std::vector<std::string>& securities,
+                                        const std::vector<std::string>& fields, SEXP options_, SEXP overrides_,
+                                        bool verbose, const Identity* identity) {
+    return bdpSubmit(engine, securities, std::make_shared<RefDataLayout>(fields, options_, overrides_),
+                     verbose, identity);
+}
+
+// Rows sharing a set of overrides, sent as one request; the overrides of a
+// row are those of its non-missing values.
+struct OverrideGroup {
+    std::vector<std::pair<std::string, std::string>> overrides;
+    std::vector<size_t> rows;
+    std::vector<std::string> securities;
+    std::shared_ptr<RefDataState> state;
+};
+
+std::vector<OverrideGroup> groupByOverrides(const std::vector<std::string>& securities, Rcpp::List overrides) {
+    Rcpp::CharacterVector names(overrides.names());
+    std::vector<Rcpp::CharacterVector> cols;
+    for (R_len_t k = 0; k < overrides.size(); ++k) {
+        cols.push_back(Rcpp::CharacterVector(overrides[k]));
+        if (static_cast<size_t>(cols.back().size()) != securities.size()) {
+            Rcpp::stop("Need one row of overrides per security.");
+        }
+    }
+    std::vector<OverrideGroup> groups;
+    std::unordered_map<std::string, size_t> index;
+    for (size_t i = 0; i < securities.size(); ++i) {
+        std::vector<std::pair<std::string, std::string>> o;
+        std::string key;
+        for (size_t k = 0; k < cols.size(); ++k) {
+            SEXP v = STRING_ELT(cols[k], i);
+            if (v == NA_STRING) continue;
+            o.emplace_back(static_cast<std::string>(names[k]), CHAR(v));
+            key += std::to_string(k) + '=' + CHAR(v) + '\x1f';
+        }
+        auto it = index.find(key);
+        if (it == index.end()) {
+            it = index.emplace(key, groups.size()).first;
+            groups.push_back(OverrideGroup{o, {}, {}, nullptr});
+        }
+        groups[it->second].rows.push_back(i);
+        groups[it->second].securities.push_back(securities[i]);
+    }
+    return groups;
+}
+
+namespace {
+    // a bdp prepared once and executed for any number of security sets; the
+    // external pointer protects the connection and identity
+    struct PreparedBdp {
+        std::shared_ptr<const RefDataLayout> layout;
+        bool verbose;
+    };
+
+    void preparedFinalizer(SEXP prepared_) {
+        PreparedBdp* p = reinterpret_cast<PreparedBdp*>(R_ExternalPtrAddr(prepared_));
+        if (p) {
+            delete p;
+            R_ClearExternalPtr(prepared_);
         }
     }
 }
@@ -99,47 +270,91 @@ Rcpp::List bdp_Impl(SEXP con_, std::vector<std::string> securities, std::vector<
 
 #if defined(HaveBlp)
 
-    // via Rcpp Attributes we get a try/catch block with error propagation to R "for free"
-    Session* session =
-        reinterpret_cast<Session*>(checkExternalPointer(con_, "blpapi::Session*"));
-
-    // get the field info
-    std::vector<FieldInfo> fldinfos(getFieldTypes(session, fields));
-    std::vector<RblpapiT> rtypes;
-    for(auto f : fldinfos) {
-        rtypes.push_back(fieldInfoToRblpapiT(f.datatype,f.ftype));
-        //std::cout << f.id << ":" << f.mnemonic << ":" << f.datatype << ":" << f.ftype << std::endl;
-    }
-    Rcpp::List res(allocateDataFrame(securities, fields, rtypes));
-
-    const std::string rdsrv = "//blp/refdata";
-    if (!session->openService(rdsrv.c_str())) {
-        Rcpp::stop("Failed to open " + rdsrv);
-    }
-
-    Service refDataService = session->getService(rdsrv.c_str());
-    Request request = refDataService.createRequest("ReferenceDataRequest");
-    createStandardRequest(request, securities, fields, options_, overrides_);
-    sendRequestWithIdentity(session, request, identity_);
-
-    while (true) {
-        Event event = session->nextEvent();
-        switch (event.eventType()) {
-        case Event::RESPONSE:
-        case Event::PARTIAL_RESPONSE:
-            getBDPResult(event, res, securities, fields, rtypes, verbose);
-            break;
-        default:
-            MessageIterator msgIter(event);
-            while (msgIter.next()) {
-                Message msg = msgIter.message();
-                //FIXME:: capture messages here for debugging
-            }
-        }
-        if (event.eventType() == Event::RESPONSE) { break; }
+    ConnectionEngine engine(con_, securities);
+    auto state = bdpSubmit(*engine, securities, fields, options_, overrides_, verbose, engine.identity(identity_));
+    engine->await(state);
+    return state->materialize();
+
+#else // ie no Blp
+    return Rcpp::List();
+#endif
+}
+
+// [[Rcpp::export]]
+SEXP bdpAsync_Impl(SEXP con_, std::vector<std::string> securities, std::vector<std::string> fields,
+                   SEXP options_, SEXP overrides_, bool verbose, SEXP identity_) {
+#if defined(HaveBlp)
+    ConnectionEngine engine(con_, securities);
+    if (!engine.routed()) {
+        Rcpp::stop("Asynchronous requests need a connection with dispatcher threads.");
     }
-    return res;
+    return createRequestHandle(con_, *engine, bdpSubmit(*engine, securities, fields, options_, overrides_,
+                                               verbose, engine.identity(identity_)));
+#else // ie no Blp
+    return R_NilValue;
+#endif
+}
+
+// [[Rcpp::export]]
+SEXP bdpPrepare_Impl(SEXP con_, std::vector<std::string> fields, SEXP options_, SEXP overrides_,
+                     bool verbose, SEXP identity_) {
+#if defined(HaveBlp)
+    ConnectionEngine engine(con_);
+    engine.identity(identity_);         // checked once here
+    auto layout = std::make_shared<RefDataLayout>(fields, options_, overrides_);
+    layout->rtypes = fieldTypes(engine, fields);
+    PreparedBdp* p = new PreparedBdp{layout, verbose};
+    SEXP prepared_ = Rcpp::Shield<SEXP>(createExternalPointer<PreparedBdp>(p, preparedFinalizer,
+                                                                           "Rblpapi::PreparedBdp*"));
+    R_SetExternalPtrProtected(prepared_, Rcpp::List::create(con_, identity_));
+    return prepared_;
+#else // ie no Blp
+    return R_NilValue;
+#endif
+}
+
+// [[Rcpp::export]]
+Rcpp::List bdpExecute_Impl(SEXP prepared_, std::vector<std::string> securities) {
+#if defined(HaveBlp)
+    PreparedBdp* p = reinterpret_cast<PreparedBdp*>(checkExternalPointer(prepared_, "Rblpapi::PreparedBdp*"));
+    Rcpp::List protect(R_ExternalPtrProtected(prepared_));
+    SEXP con_ = protect[0], identity_ = protect[1];
+    ConnectionEngine engine(con_, securities);
+    auto state = bdpSubmit(*engine, securities, p->layout, p->verbose, engine.identity(identity_));
+    engine->await(state);
+    return state->materialize();
+#else // ie no Blp
+    return Rcpp::List();
+#endif
+}
 
+// [[Rcpp::export]]
+Rcpp::List bdpRows_Impl(SEXP con_, std::vector<std::string> securities, std::vector<std::string> fields,
+                        SEXP options_, Rcpp::List overrides, bool verbose, SEXP identity_) {
+#if defined(HaveBlp)
+    std::vector<OverrideGroup> groups = groupByOverrides(securities, overrides);
+    ConnectionEngine engine(con_, securities);
+    const Identity* identity = engine.identity(identity_);
+    // types once for all groups, whose requests are then all in flight at once
+    RefDataLayout base(fields, options_, R_NilValue);
+    base.rtypes = fieldTypes(engine, fields);
+    Service refdata = engine->service("//blp/refdata");
+    for (auto& g : groups) {
+        auto layout = std::make_shared<RefDataLayout>(base, g.overrides);
+        Request* request = new Request(refdata.createRequest("ReferenceDataRequest"));
+        g.state = std::make_shared<RefDataState>(g.securities, layout, request, verbose);
+        layout->fill(*request, g.securities);
+        g.state->start(*engine, identity);
+    }
+    try {
+        for (auto& g : groups) engine->await(g.state);
+    } catch (...) {
+        for (auto& g : groups) engine->cancel(g.state);
+        throw;
+    }
+    Rcpp::List res(allocateDataFrame(securities, fields, base.rtypes));
+    for (auto& g : groups) g.state->fillInto(res, g.rows);
+    return res;
 #else // ie no Blp
     return Rcpp::List();
 #endif
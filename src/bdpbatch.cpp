@@ -0,0 +1,282 @@
+// -*- mode: C++; c-indent-level: 4; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+//
+//  bdpbatch.cpp -- batches of bdp queries packed into few requests
+//
+//  Copyright (C) 2026  Whit Armstrong and Dirk Eddelbuettel
+//
+//  This file is part of Rblpapi
+//
+//  Rblpapi is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  Rblpapi is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Rblpapi.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#if defined(HaveBlp)
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <blpapi_utils.h>
+#include <refdata.h>
+
+namespace bbg = BloombergLP::blpapi;
+
+namespace {
+    typedef std::vector<std::pair<std::string, std::string>> Overrides;
+
+    struct BatchQuery {
+        std::vector<std::string> securities, fields;
+        size_t group;                   // index of its set of overrides
+    };
+
+    struct BatchRequest {
+        size_t group;
+        std::vector<std::string> securities, fields;
+        std::shared_ptr<RefDataState> state;
+    };
+
+    std::string cellKey(size_t group, const std::string& security, const std::string& field) {
+        return std::to_string(group) + '\x1f' + security + '\x1f' + field;
+    }
+
+    // Packs the cells of queued queries into requests: queries with equal
+    // overrides share requests, securities needing the same fields form a
+    // block, and blocks are merged as long as at most half the cells of the
+    // merged block were not asked for. Blocks are then cut to the limits on
+    // fields and on securities times fields per request.
+    class BatchPlanner {
+    public:
+        BatchPlanner(size_t maxFields, size_t maxCells) : maxFields(maxFields), maxCells(maxCells) {}
+
+        size_t group(const Overrides& o) {
+            Overrides sorted(o);
+            std::sort(sorted.begin(), sorted.end());
+            std::string key;
+            for (const auto& p : sorted) key += p.first + '=' + p.second + '\x1f';
+            auto it = groupIndex.find(key);
+            if (it != groupIndex.end()) return it->second;
+            groupIndex.emplace(key, groups.size());
+            groups.push_back(Group{sorted, {}, {}});
+            return groups.size() - 1;
+        }
+
+        void add(const BatchQuery& q) {
+            Group& g = groups[q.group];
+            for (const auto& s : q.securities) {
+                auto it = g.index.find(s);
+                if (it == g.index.end()) {
+                    it = g.index.emplace(s, g.needs.size()).first;
+                    g.needs.emplace_back(s, std::set<std::string>());
+                }
+                g.needs[it->second].second.insert(q.fields.begin(), q.fields.end());
+            }
+        }
+
+        const Overrides& overrides(size_t group) const { return groups[group].overrides; }
+
+        std::vector<BatchRequest> plan() const {
+            std::vector<BatchRequest> requests;
+            for (size_t gi = 0; gi < groups.size(); ++gi) {
+                for (const Block& b : merge(blocks(groups[gi]))) {
+                    cut(gi, b, requests);
+                }
+            }
+            return requests;
+        }
+
+    private:
+        struct Group {
+            Overrides overrides;
+            std::vector<std::pair<std::string, std::set<std::string>>> needs;   // by security
+            std::unordered_map<std::string, size_t> index;
+        };
+
+        struct Block {
+            std::set<std::string> fields;
+            std::vector<std::string> securities;
+            size_t wanted;              // cells asked for
+        };
+
+        // securities by the set of fields they need, in order of appearance
+        std::vector<Block> blocks(const Group& g) const {
+            std::vector<Block> res;
+            std::map<std::set<std::string>, size_t> index;
+            for (const auto& n : g.needs) {
+                auto it = index.find(n.second);
+                if (it == index.end()) {
+                    it = index.emplace(n.second, res.size()).first;
+                    res.push_back(Block{n.second, {}, 0});
+                }
+                res[it->second].securities.push_back(n.first);
+                res[it->second].wanted += n.second.size();
+            }
+            return res;
+        }
+
+        std::vector<Block> merge(std::vector<Block> blocks) const {
+            std::stable_sort(blocks.begin(), blocks.end(),
+                             [](const Block& a, const Block& b) { return a.fields.size() > b.fields.size(); });
+            std::vector<Block> merged;
+            for (auto& b : blocks) {
+                size_t best = merged.size(), bestWaste = 0;
+                for (size_t k = 0; k < merged.size(); ++k) {
+                    std::set<std::string> u(merged[k].fields);
+                    u.insert(b.fields.begin(), b.fields.end());
+                    if (u.size() > maxFields) continue;
+                    const size_t total = u.size() * (merged[k].securities.size() + b.securities.size());
+                    const size_t wanted = merged[k].wanted + b.wanted;
+                    if (total > 2 * wanted) continue;
+                    if (best == merged.size() || total - wanted < bestWaste) {
+                        best = k;
+                        bestWaste = total - wanted;
+                    }
+                }
+                if (best == merged.size()) {
+                    merged.push_back(std::move(b));
+                } else {
+                    Block& m = merged[best];
+                    m.fields.insert(b.fields.begin(), b.fields.end());
+                    m.securities.insert(m.securities.end(), b.securities.begin(), b.securities.end());
+                    m.wanted += b.wanted;
+                }
+            }
+            return merged;
+        }
+
+        void cut(size_t group, const Block& b, std::vector<BatchRequest>& requests) const {
+            const std::vector<std::string> fields(b.fields.begin(), b.fields.end());
+            for (size_t f0 = 0; f0 < fields.size(); f0 += maxFields) {
+                const size_t f1 = std::min(fields.size(), f0 + maxFields);
+                const size_t rows = std::max<size_t>(1, maxCells / (f1 - f0));
+                for (size_t s0 = 0; s0 < b.securities.size(); s0 += rows) {
+                    const size_t s1 = std::min(b.securities.size(), s0 + rows);
+                    requests.push_back(BatchRequest{group,
+                                                    std::vector<std::string>(b.securities.begin() + s0,
+                                                                             b.securities.begin() + s1),
+                                                    std::vector<std::string>(fields.begin() + f0,
+                                                                             fields.begin() + f1),
+                                                    nullptr});
+                }
+            }
+        }
+
+        size_t maxFields, maxCells;
+        std::vector<Group> groups;
+        std::unordered_map<std::string, size_t> groupIndex;
+    };
+}
+#else
+#include <Rcpp/Lightest>
+#endif
+
+// queries is a list of lists with elements securities, fields and overrides
+//
+// [[Rcpp::export]]
+Rcpp::List bdpBatch_Impl(SEXP con_, Rcpp::List queries, SEXP options_, int maxFields, int maxCells,
+                         SEXP identity_) {
+#if defined(HaveBlp)
+    if (maxFields < 1 || maxCells < 1) {
+        Rcpp::stop("Request limits must be positive.");
+    }
+    std::vector<BatchQuery> batch;
+    std::vector<Overrides> overrides;
+    std::vector<std::string> allFields, allSecurities;
+    for (R_len_t i = 0; i < queries.size(); ++i) {
+        Rcpp::List q(queries[i]);
+        BatchQuery b;
+        b.securities = Rcpp::as<std::vector<std::string>>(q["securities"]);
+        b.fields = Rcpp::as<std::vector<std::string>>(q["fields"]);
+        overrides.push_back(RefDataLayout(b.fields, R_NilValue, q["overrides"]).overrides);
+        allFields.insert(allFields.end(), b.fields.begin(), b.fields.end());
+        allSecurities.insert(allSecurities.end(), b.securities.begin(), b.securities.end());
+        batch.push_back(b);
+    }
+    ConnectionEngine engine(con_, allSecurities);
+    const bbg::Identity* identity = engine.identity(identity_);
+
+    // requests no larger than the throttle of the session currently suggests
+    size_t cells = maxCells;
+    if (Throttle* throttle = engine->throttle()) {
+        cells = std::min(cells, throttle->cells());
+    }
+    BatchPlanner planner(maxFields, cells);
+    for (size_t q = 0; q < batch.size(); ++q) {
+        batch[q].group = planner.group(overrides[q]);
+        planner.add(batch[q]);
+    }
+    std::vector<BatchRequest> requests = planner.plan();
+    if (requests.empty()) {
+        return Rcpp::List(batch.size());
+    }
+
+    std::sort(allFields.begin(), allFields.end());
+    allFields.erase(std::unique(allFields.begin(), allFields.end()), allFields.end());
+    // one lookup of the types for all requests, which are then all in flight at once
+    std::vector<RblpapiT> types = fieldTypes(engine, allFields);
+    std::unordered_map<std::string, RblpapiT> typeOf;
+    for (size_t j = 0; j < allFields.size(); ++j) typeOf.emplace(allFields[j], types[j]);
+
+    RefDataLayout options(std::vector<std::string>(), options_, R_NilValue);
+    bbg::Service refdata = engine->service("//blp/refdata");
+    std::unordered_map<std::string, std::pair<size_t, size_t>> cellIndex;     // to request, row and column
+    for (size_t r = 0; r < requests.size(); ++r) {
+        BatchRequest& req = requests[r];
+        std::vector<RblpapiT> rtypes;
+        for (const auto& f : req.fields) rtypes.push_back(typeOf[f]);
+        RefDataLayout withOverrides(options, planner.overrides(req.group));
+        auto layout = std::make_shared<RefDataLayout>(withOverrides, req.fields, rtypes);
+        bbg::Request* request = new bbg::Request(refdata.createRequest("ReferenceDataRequest"));
+        req.state = std::make_shared<RefDataState>(req.securities, layout, request, false);
+        layout->fill(*request, req.securities);
+        for (size_t i = 0; i < req.securities.size(); ++i) {
+            for (size_t j = 0; j < req.fields.size(); ++j) {
+                cellIndex.emplace(cellKey(req.group, req.securities[i], req.fields[j]),
+                                  std::make_pair(r, i * req.fields.size() + j));
+            }
+        }
+        req.state->start(*engine, identity);
+    }
+    try {
+        for (auto& req : requests) engine->await(req.state);
+    } catch (...) {
+        for (auto& req : requests) engine->cancel(req.state);
+        throw;
+    }
+
+    Rcpp::List res(batch.size());
+    for (size_t q = 0; q < batch.size(); ++q) {
+        const BatchQuery& b = batch[q];
+        std::vector<RblpapiT> rtypes;
+        for (const auto& f : b.fields) rtypes.push_back(typeOf[f]);
+        Rcpp::List df(allocateDataFrame(b.securities, b.fields, rtypes));
+        for (size_t j = 0; j < b.fields.size(); ++j) {
+            SEXP col = df[j];
+            for (size_t i = 0; i < b.securities.size(); ++i) {
+                const auto& at = cellIndex.at(cellKey(b.group, b.securities[i], b.fields[j]));
+                const BatchRequest& req = requests[at.first];
+                setDfCell(col, i, req.state->cell(at.second / req.fields.size(), at.second % req.fields.size()));
+            }
+        }
+        res[q] = df;
+    }
+    res.attr("requests") = static_cast<int>(requests.size());
+    res.attr("cells") = static_cast<double>(cellIndex.size());
+    return res;
+#else // ie no Blp
+    return Rcpp::List();
+#endif
+}
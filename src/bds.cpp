@@ -29,14 +29,12 @@
 #include <blpapi_message.h>
 #include <blpapi_element.h>
 #include <blpapi_utils.h>
+#include <requestengine.h>
 
-using BloombergLP::blpapi::Session;
 using BloombergLP::blpapi::Service;
 using BloombergLP::blpapi::Request;
-using BloombergLP::blpapi::Event;
 using BloombergLP::blpapi::Element;
 using BloombergLP::blpapi::Message;
-using BloombergLP::blpapi::MessageIterator;
 using BloombergLP::blpapi::Name;
 
 void populateDfRowBDS(Rcpp::RObject ans, R_len_t row_index, Element& e) {
@@ -215,32 +213,35 @@ Rcpp::List bulkArrayToDf(Element& fieldData) {
     return buildDataFrame(lazy_frame);
 }
 
-Rcpp::List BulkDataResponseToDF(Event& event, std::string& requested_field, std::string response_type, bool verbose) {
-    MessageIterator msgIter(event);
-    if(!msgIter.next()) {
-        Rcpp::stop("Not a valid MessageIterator.");
-    }
-
-    Message msg = msgIter.message();
-    Element response = msg.asElement();
-    if (verbose) response.print(Rcpp::Rcout);
-    if(std::strcmp(response.name().string(),response_type.c_str())) {
-        Rcpp::stop("Not a valid " + response_type + ".");
+// securities may be spread over several partial responses
+Rcpp::List BulkDataResponseToDF(const std::vector<Message>& responses, const std::string& requested_field,
+                                const std::string& response_type, bool verbose) {
+    size_t n = 0;
+    for (const Message& msg : responses) {
+        Element response = msg.asElement();
+        if (verbose) response.print(Rcpp::Rcout);
+        if(std::strcmp(response.name().string(),response_type.c_str())) {
+            Rcpp::stop("Not a valid " + response_type + ".");
+        }
+        n += response.getElement(Name{"securityData"}).numValues();
     }
-    Element securityData = response.getElement(Name{"securityData"});
 
-    Rcpp::List ans(securityData.numValues());
-    std::vector<std::string> ans_names(securityData.numValues());
-
-    for(size_t i = 0; i < securityData.numValues(); ++i) {
-        Element this_security = securityData.getValueAsElement(i);
-        ans_names[i] = this_security.getElementAsString(Name{"security"});
-        Element fieldData = this_security.getElement(Name{"fieldData"});
-        if(!fieldData.hasElement(Name{requested_field.c_str()})) {
-            ans[i] = R_NilValue;
-        } else {
-            Element e = fieldData.getElement(Name{requested_field.c_str()});
-            ans[i] = bulkArrayToDf(e);
+    Rcpp::List ans(n);
+    std::vector<std::string> ans_names(n);
+
+    size_t k = 0;
+    for (const Message& msg : responses) {
+        Element securityData = msg.asElement().getElement(Name{"securityData"});
+        for(size_t i = 0; i < securityData.numValues(); ++i, ++k) {
+            Element this_security = securityData.getValueAsElement(i);
+            ans_names[k] = this_security.getElementAsString(Name{"security"});
+            Element fieldData = this_security.getElement(Name{"fieldData"});
+            if(!fieldData.hasElement(Name{requested_field.c_str()})) {
+                ans[k] = R_NilValue;
+            } else {
+                Element e = fieldData.getElement(Name{requested_field.c_str()});
+                ans[k] = bulkArrayToDf(e);
+            }
         }
     }
     ans.attr("names") = ans_names;
@@ -258,17 +259,9 @@ Rcpp::List bds_Impl(SEXP con_, std::vector<std::string> securities,
 
 #if defined(HaveBlp)
 
-    Session* session =
-        reinterpret_cast<Session*>(checkExternalPointer(con_, "blpapi::Session*"));
+    ConnectionEngine engine(con_, securities);
 
-    std::vector<std::string> field_types;
-
-    const std::string rdsrv = "//blp/refdata";
-    if (!session->openService(rdsrv.c_str())) {
-        Rcpp::stop("Failed to open " + rdsrv);
-    }
-
-    Service refDataService = session->getService(rdsrv.c_str());
+    Service refDataService = engine->service("//blp/refdata");
     Request request = refDataService.createRequest("ReferenceDataRequest");
     for (size_t i = 0; i < securities.size(); i++) {
         request.getElement(Name{"securities"}).appendValue(securities[i].c_str());
@@ -277,25 +270,7 @@ Rcpp::List bds_Impl(SEXP con_, std::vector<std::string> securities,
     appendOptionsToRequest(request,options_);
     appendOverridesToRequest(request,overrides_);
 
-    sendRequestWithIdentity(session, request, identity_);
-
-    while (true) {
-        Event event = session->nextEvent();
-        switch (event.eventType()) {
-        case Event::RESPONSE:
-        case Event::PARTIAL_RESPONSE:
-            return BulkDataResponseToDF(event, field, "ReferenceDataResponse", verbose);
-            break;
-        default:
-            MessageIterator msgIter(event);
-            while (msgIter.next()) {
-                Message msg = msgIter.message();
-                //FIXME:: capture messages here for debugging
-            }
-        }
-        if (event.eventType() == Event::RESPONSE) { break; }
-    }
-    return Rcpp::List();
+    return BulkDataResponseToDF(engine.request(request, identity_), field, "ReferenceDataResponse", verbose);
 #else // ie no Blp
     return Rcpp::List();
 #endif
@@ -308,17 +283,9 @@ Rcpp::List getPortfolio_Impl(SEXP con_, std::vector<std::string> securities,
 
 #if defined(HaveBlp)
 
-    Session* session =
-        reinterpret_cast<Session*>(checkExternalPointer(con_, "blpapi::Session*"));
-
-    std::vector<std::string> field_types;
-
-    const std::string rdsrv = "//blp/refdata";
-    if (!session->openService(rdsrv.c_str())) {
-        Rcpp::stop("Failed to open " + rdsrv);
-    }
+    ConnectionEngine engine(con_, securities);
 
-    Service refDataService = session->getService(rdsrv.c_str());
+    Service refDataService = engine->service("//blp/refdata");
     Request request = refDataService.createRequest("PortfolioDataRequest");
     for (size_t i = 0; i < securities.size(); i++) {
         request.getElement(Name{"securities"}).appendValue(securities[i].c_str());
@@ -327,25 +294,7 @@ Rcpp::List getPortfolio_Impl(SEXP con_, std::vector<std::string> securities,
     appendOptionsToRequest(request,options_);
     appendOverridesToRequest(request,overrides_);
 
-    sendRequestWithIdentity(session, request, identity_);
-
-    while (true) {
-        Event event = session->nextEvent();
-        switch (event.eventType()) {
-        case Event::RESPONSE:
-        case Event::PARTIAL_RESPONSE:
-            return BulkDataResponseToDF(event, field, "PortfolioDataResponse", verbose);
-            break;
-        default:
-            MessageIterator msgIter(event);
-            while (msgIter.next()) {
-                Message msg = msgIter.message();
-                //FIXME:: capture messages here for debugging
-            }
-        }
-        if (event.eventType() == Event::RESPONSE) { break; }
-    }
-    return Rcpp::List();
+    return BulkDataResponseToDF(engine.request(request, identity_), field, "PortfolioDataResponse", verbose);
 #else // ie no Blp
     return Rcpp::List();
 #endif
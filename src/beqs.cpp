@@ -30,6 +30,7 @@
 #include <blpapi_message.h>
 #include <blpapi_element.h>
 #include <blpapi_utils.h>
+#include <requestengine.h>
 #include <iostream>
 #include <stdlib.h>
 #include <string.h>
@@ -40,21 +41,14 @@
 using namespace std;
 using namespace Rcpp;
 
-using BloombergLP::blpapi::Session;
 using BloombergLP::blpapi::Service;
 using BloombergLP::blpapi::Request;
-using BloombergLP::blpapi::Event;
 using BloombergLP::blpapi::Element;
 using BloombergLP::blpapi::Message;
-using BloombergLP::blpapi::MessageIterator;
 using BloombergLP::blpapi::Name;
 
-Rcpp::DataFrame processResponseEvent(Event event, const bool verbose) {
+Rcpp::DataFrame processResponse(const Message& msg, const bool verbose) {
 
-    MessageIterator msgIter(event); 			// create message iterator
-    if (!msgIter.next()) Rcpp::stop("Not a valid MessageIterator.");
-
-    Message msg = msgIter.message(); 			// get message
     if (verbose) msg.print(Rcpp::Rcout);
 
     Element response = msg.asElement(); 		// view as element
@@ -179,14 +173,9 @@ Rcpp::DataFrame beqs_Impl(SEXP con,
 
 #if defined(HaveBlp)
 
-    Session* session = reinterpret_cast<Session*>(checkExternalPointer(con, "blpapi::Session*"));
-
-    const std::string rdsrv = "//blp/refdata";
-    if (!session->openService(rdsrv.c_str())) {
-        Rcpp::stop("Failed to open " + rdsrv);
-    }
+    ConnectionEngine engine(con);
 
-    Service refDataService = session->getService(rdsrv.c_str());
+    Service refDataService = engine->service("//blp/refdata");
     Request request = refDataService.createRequest("BeqsRequest");
 
     request.set(Name{"screenName"}, screenName.c_str());
@@ -208,36 +197,11 @@ Rcpp::DataFrame beqs_Impl(SEXP con,
     }
 
     if (verbose) Rcpp::Rcout <<"Sending Request: " << request << std::endl;
-    session->sendRequest(request);
-
-    DataFrame ans;
-
-    // Wait for events from Session
-    bool done = false;
-    while (!done) {
-        Event event = session->nextEvent();
-        if (event.eventType() == Event::PARTIAL_RESPONSE) {
-            if (verbose) Rcpp::Rcout << "Processing Partial Response" << std::endl;
-            ans = processResponseEvent(event, verbose);
-        } else if (event.eventType() == Event::RESPONSE) {
-            if (verbose) Rcpp::Rcout << "Processing Response" << std::endl;
-            ans = processResponseEvent(event, verbose);
-            done = true;
-        } else {
-            MessageIterator msgIter(event);
-            while (msgIter.next()) {
-                Message msg = msgIter.message();
-                if (event.eventType() == Event::SESSION_STATUS) {
-                    if (msg.messageType() == "SessionTerminated" ||
-                        msg.messageType() == "SessionStartupFailure") {
-                        done = true;
-                    }
-                }
-            }
-        }
-    }
+    std::vector<Message> responses = engine.request(request);
 
-    return ans;
+    // a partial response is superseded by those following it
+    if (responses.empty()) Rcpp::stop("No response received.");
+    return processResponse(responses.back(), verbose);
 
 #else // ie no Blp
     return Rcpp::DataFrame();
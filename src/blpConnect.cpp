@@ -25,6 +25,9 @@
 #include <string>
 #include <blpapi_session.h>
 #include <finalizers.h>
+#include <blpapi_utils.h>
+#include <eventrouter.h>
+#include <sessioncontext.h>
 
 using BloombergLP::blpapi::Session;
 using BloombergLP::blpapi::SessionOptions;
@@ -33,20 +36,8 @@ const std::string APP_PREFIX("AuthenticationMode=APPLICATION_ONLY;"
 			     "ApplicationAuthenticationType=APPNAME_AND_KEY;"
 			     "ApplicationName=");
 
-static void sessionFinalizer(SEXP session_) {
-    Session* session = reinterpret_cast<Session*>(R_ExternalPtrAddr(session_));
-    if (session) {
-        delete session;
-        R_ClearExternalPtr(session_);
-    }
-}
-#else
-#include <Rcpp/Lightest>
-#endif
-
-// [[Rcpp::export]]
-SEXP blpConnect_Impl(const std::string host, const int port, SEXP app_name_, SEXP app_identity_key_) {
-#if defined(HaveBlp)
+SessionOptions createSessionOptions(const std::string& host, const int port,
+                                    SEXP app_name_, SEXP app_identity_key_) {
     SessionOptions sessionOptions;
     sessionOptions.setServerHost(host.c_str());
     sessionOptions.setServerPort(port);
@@ -60,6 +51,33 @@ SEXP blpConnect_Impl(const std::string host, const int port, SEXP app_name_, SEX
         std::string app_identity_key = Rcpp::as<std::string>(app_identity_key_);
         sessionOptions.setApplicationIdentityKey(app_identity_key);
     }
+    return sessionOptions;
+}
+
+static void sessionFinalizer(SEXP session_) {
+    Session* session = reinterpret_cast<Session*>(R_ExternalPtrAddr(session_));
+    if (session) {
+        delete session;
+        R_ClearExternalPtr(session_);
+    }
+}
+
+static void routerFinalizer(SEXP router_) {
+    EventRouter* router = reinterpret_cast<EventRouter*>(R_ExternalPtrAddr(router_));
+    if (router) {
+        delete router;
+        R_ClearExternalPtr(router_);
+    }
+}
+#else
+#include <Rcpp/Lightest>
+#endif
+
+// [[Rcpp::export]]
+SEXP blpConnect_Impl(const std::string host, const int port, SEXP app_name_, SEXP app_identity_key_,
+                     std::vector<std::string> services, int timeout) {
+#if defined(HaveBlp)
+    SessionOptions sessionOptions = createSessionOptions(host, port, app_name_, app_identity_key_);
     Session* sp = new Session(sessionOptions);
 
     if (!sp->start()) {
@@ -69,7 +87,32 @@ SEXP blpConnect_Impl(const std::string host, const int port, SEXP app_name_, SEX
         Rcpp::stop("Session pointer is NULL\n");
     }
 
-    return createExternalPointer<Session>(sp, sessionFinalizer, "blpapi::Session*");
+    SEXP session_ = Rcpp::Shield<SEXP>(createExternalPointer<Session>(sp, sessionFinalizer, "blpapi::Session*"));
+    SessionContext* context = new SessionContext();
+    attachSessionContext(session_, context);
+    // services which fail to open here are opened again when first used
+    context->warmUp(*sp, services, timeout);
+    return session_;
+#else // ie no Blp
+    return R_NilValue;
+#endif
+}
+
+// [[Rcpp::export]]
+SEXP blpConnectRouter_Impl(const std::string host, const int port, SEXP app_name_, SEXP app_identity_key_,
+                           int threads, std::vector<std::string> services, int timeout) {
+#if defined(HaveBlp)
+    SessionOptions sessionOptions = createSessionOptions(host, port, app_name_, app_identity_key_);
+    EventRouter* router = new EventRouter(sessionOptions, threads);
+    SEXP router_ = Rcpp::Shield<SEXP>(createExternalPointer<EventRouter>(router, routerFinalizer,
+                                                                         "Rblpapi::EventRouter*"));
+    try {
+        router->start(timeout);
+        router->warmUp(services, timeout);
+    } catch (const std::exception& e) {
+        Rcpp::stop(e.what());
+    }
+    return router_;
 #else // ie no Blp
     return R_NilValue;
 #endif
@@ -41,7 +41,6 @@ using std::string;
 using BloombergLP::blpapi::Session;
 using BloombergLP::blpapi::Service;
 using BloombergLP::blpapi::Request;
-using BloombergLP::blpapi::Identity;
 using BloombergLP::blpapi::Datetime;
 using BloombergLP::blpapi::DatetimeParts;
 using BloombergLP::blpapi::Element;
@@ -209,16 +208,6 @@ void createStandardRequest(Request& request,
   if(overrides_ != R_NilValue) { appendOverridesToRequest(request,overrides_); }
 }
 
-void sendRequestWithIdentity(Session* session, Request& request, SEXP identity_) {
-  Identity* ip;
-  if(identity_ != R_NilValue) {
-    ip = reinterpret_cast<Identity*>(checkExternalPointer(identity_,"blpapi::Identity*"));
-    session->sendRequest(request,*ip);
-  } else {
-    session->sendRequest(request);
-  }
-}
-
 void populateDfRow(SEXP ans, R_len_t row_index, const Element& e, RblpapiT rblpapitype) {
   // the vectors are already initialized to NAs
   // so no need to set as NA here
@@ -250,12 +239,59 @@ void populateDfRow(SEXP ans, R_len_t row_index, const Element& e, RblpapiT rblpa
   }
 }
 
-Rcpp::NumericVector createPOSIXtVector(const std::vector<double> & ticks,
-                                       const std::string tz) {
-    Rcpp::NumericVector pt(ticks.begin(), ticks.end());
-    pt.attr("class") = Rcpp::CharacterVector::create("POSIXct", "POSIXt");
-    pt.attr("tzone") = tz;
-    return pt;
+FieldValue elementToCell(const Element& e, RblpapiT rblpapitype) {
+  FieldValue v;
+  if(e.isNull()) { return v; }
+
+  // no Rcpp::stop() in here, errors are thrown as std::runtime_error
+  switch(rblpapitype) {
+  case RblpapiT::Logical:
+    v.kind = FieldValue::Logical; v.num = e.getValueAsBool(); break;
+  case RblpapiT::Integer:
+    v.kind = FieldValue::Integer; v.num = e.getValueAsInt32(); break;
+  case RblpapiT::Integer64:
+  case RblpapiT::Double:
+  case RblpapiT::Float:
+    v.kind = FieldValue::Double; v.num = e.getValueAsFloat64(); break;
+  case RblpapiT::Date:
+    v.kind = FieldValue::Date;
+    if(e.datatype()==BLPAPI_DATATYPE_FLOAT32 || e.datatype()==BLPAPI_DATATYPE_FLOAT64) {
+      const double yyyymmdd = e.getValueAsFloat64();
+      if(yyyymmdd < 0 || trunc(yyyymmdd) != yyyymmdd) {
+        throw std::runtime_error("Attempt to convert a double value with time parts set to an R Date.");
+      }
+      const int date = static_cast<int>(yyyymmdd);
+      v.num = daysFromCivil(date / 10000, (date / 100) % 100, date % 100);
+    } else {
+      const Datetime dt = e.getValueAsDatetime();
+      if(dt.hasParts(DatetimeParts::TIME)) {
+        throw std::runtime_error("Attempt to convert a Datetime with time parts set to an R Date.");
+      }
+      v.num = daysFromCivil(dt.year(), dt.month(), dt.day());
+    }
+    break;
+  case RblpapiT::Datetime:
+    v.kind = FieldValue::Datetime; v.num = bbgDateToPOSIX(e.getValueAsDatetime()); break;
+  default: // try to convert it as a string
+    v.kind = FieldValue::String; v.str = e.getValueAsString(); break;
+  }
+  return v;
+}
+
+void setDfCell(SEXP ans, R_len_t row_index, const FieldValue& v) {
+  // the vectors are already initialized to NAs
+  switch(v.kind) {
+  case FieldValue::Null:
+    break;
+  case FieldValue::Logical:
+    LOGICAL(ans)[row_index] = v.num != 0.0; break;
+  case FieldValue::Integer:
+    INTEGER(ans)[row_index] = static_cast<int>(v.num); break;
+  case FieldValue::String:
+    SET_STRING_ELT(ans,row_index,Rf_mkCharCE(v.str.c_str(), CE_UTF8)); break;
+  default:
+    REAL(ans)[row_index] = v.num; break;
+  }
 }
 
 std::string vectorToCSVString(const std::vector<std::string>& vec) {
@@ -348,74 +384,6 @@ SEXP allocateDataFrameColumn(RblpapiT rblpapitype, const size_t n) {
     return ans;
 }
 
-FieldInfo getFieldType(Session *session, Service& fieldInfoService, const std::string& field) {
-
-  Request request = fieldInfoService.createRequest("FieldInfoRequest");
-  request.append(Name{"id"}, field.c_str());
-  request.set(Name{"returnFieldDocumentation"}, false);
-  session->sendRequest(request);
-
-  FieldInfo ans;
-  while (true) {
-    Event event = session->nextEvent();
-    if (event.eventType() != Event::RESPONSE &&
-        event.eventType() != Event::PARTIAL_RESPONSE) {
-      continue;
-    }
-
-    MessageIterator msgIter(event);
-    while (msgIter.next()) {
-      Message msg = msgIter.message();
-      //msg.asElement().print(std::cout);
-      Element fields = msg.getElement(Name{"fieldData"});
-      if(fields.numValues() > 1) {
-        Rcpp::stop("getFieldType: too many fields returned.");
-      }
-      Element field = fields.getValueAsElement(0);
-      if (!field.hasElement(Name{"id"})) {
-        Rcpp::stop("Did not find 'id' in repsonse.");
-      }
-      if (field.hasElement(Name{"fieldError"})) {
-        std::ostringstream err;
-        err << "Bad field: " << field.getElementAsString(Name{"id"}) << std::endl;
-        Rcpp::stop(err.str());
-      }
-      if (!field.hasElement(Name{"fieldInfo"})) {
-        Rcpp::stop("Did not find fieldInfo in repsonse.");
-      }
-      Element fieldInfo = field.getElement(Name{"fieldInfo"});
-      if (!fieldInfo.hasElement(Name{"mnemonic"}) ||
-          !fieldInfo.hasElement(Name{"datatype"}) ||
-          !fieldInfo.hasElement(Name{"ftype"})) {
-        Rcpp::stop("fieldInfo missing info mnemonic/datatype/ftype.");
-      }
-      ans.id = field.getElementAsString(Name{"id"});
-      ans.mnemonic = fieldInfo.getElementAsString(Name{"mnemonic"});
-      ans.datatype = fieldInfo.getElementAsString(Name{"datatype"});
-      ans.ftype = fieldInfo.getElementAsString(Name{"ftype"});
-    }
-    if (event.eventType() == Event::RESPONSE) {
-      break;
-    }
-  }
-  return ans;
-}
-
-
-std::vector<FieldInfo> getFieldTypes(Session *session,
-                                     const std::vector<std::string> &fields) {
-  const std::string APIFLDS_SVC("//blp/apiflds");
-  if (!session->openService(APIFLDS_SVC.c_str())) {
-    Rcpp::stop(std::string("Failed to open " + APIFLDS_SVC));
-  }
-  Service fieldInfoService = session->getService(APIFLDS_SVC.c_str());
-  std::vector<FieldInfo> ans;
-  for(auto field : fields) {
-    ans.push_back(getFieldType(session, fieldInfoService, field));
-  }
-  return ans;
-}
-
 Rcpp::List allocateDataFrame(const vector<string>& rownames, const vector<string>& colnames, vector<RblpapiT>& coltypes) {
 
   if(colnames.size() != coltypes.size()) {
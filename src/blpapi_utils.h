@@ -28,8 +28,10 @@
 #include <blpapi_element.h>
 #include <Rcpp.h>
 #include <Rblpapi_types.h>
+#include <subscription.h>
 
 void* checkExternalPointer(SEXP xp_, const char* valid_tag);
+BloombergLP::blpapi::SessionOptions createSessionOptions(const std::string& host, const int port, SEXP app_name_, SEXP app_identity_key_);
 const int bbgDateToRDate(const BloombergLP::blpapi::Datetime& bbg_date);
 const int bbgDateToRDate(const double yyyymmdd_date);
 const double bbgDateToPOSIX(const BloombergLP::blpapi::Datetime& bbg_date);
@@ -38,17 +40,16 @@ const double bbgDatetimeToUTC(const BloombergLP::blpapi::Datetime& dt);
 void appendOptionsToRequest(BloombergLP::blpapi::Request& request, SEXP options_);
 void appendOverridesToRequest(BloombergLP::blpapi::Request& request, SEXP overrides_);
 void createStandardRequest(BloombergLP::blpapi::Request& request,const std::vector<std::string>& securities,const std::vector<std::string>& fields,SEXP options_,SEXP overrides_);
-void sendRequestWithIdentity(BloombergLP::blpapi::Session* session, BloombergLP::blpapi::Request& request, SEXP identity_);
 
 void populateDfRow(SEXP ans, R_len_t row_index, const BloombergLP::blpapi::Element& e, RblpapiT rblpapitype);
+// populateDfRow() in two steps: decoding is free of R and may run off the R thread
+FieldValue elementToCell(const BloombergLP::blpapi::Element& e, RblpapiT rblpapitype);
+void setDfCell(SEXP ans, R_len_t row_index, const FieldValue& v);
 void addPosixClass(SEXP x);
 
-Rcpp::NumericVector createPOSIXtVector(const std::vector<double> & ticks, const std::string tz="UTC");
 std::string vectorToCSVString(const std::vector<std::string>& vec);
 
 RblpapiT fieldInfoToRblpapiT(const std::string& datatype, const std::string& ftype);
 SEXP allocateDataFrameColumn(RblpapiT rblpapitype, const size_t n);
-FieldInfo getFieldType(BloombergLP::blpapi::Session *session, BloombergLP::blpapi::Service& fieldInfoService, const std::string& field);
-std::vector<FieldInfo> getFieldTypes(BloombergLP::blpapi::Session *session,const std::vector<std::string> &fields);
 Rcpp::List allocateDataFrame(const std::vector<std::string>& rownames, const std::vector<std::string>& colnames, std::vector<RblpapiT>& coltypes);
 Rcpp::List allocateDataFrame(size_t nrows, const std::vector<std::string>& colnames, const std::vector<RblpapiT>& coltypes);
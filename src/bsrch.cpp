@@ -28,6 +28,7 @@
 #include <blpapi_message.h>
 #include <blpapi_element.h>
 #include <blpapi_utils.h>
+#include <requestengine.h>
 #include <iostream>
 #include <stdlib.h>
 #include <string.h>
@@ -38,21 +39,14 @@
 using namespace std;
 using namespace Rcpp;
 
-using BloombergLP::blpapi::Session;
 using BloombergLP::blpapi::Service;
 using BloombergLP::blpapi::Request;
-using BloombergLP::blpapi::Event;
 using BloombergLP::blpapi::Element;
 using BloombergLP::blpapi::Message;
-using BloombergLP::blpapi::MessageIterator;
 using BloombergLP::blpapi::Name;
 
-Rcpp::DataFrame processBsrchResponse(Event event, const bool verbose) {
+Rcpp::DataFrame processBsrchResponse(const Message& msg, const bool verbose) {
 
-    MessageIterator msgIter(event); 			// create message iterator
-    if (!msgIter.next()) Rcpp::stop("Not a valid MessageIterator.");
-
-    Message msg = msgIter.message(); 			// get message
     if (verbose) msg.print(Rcpp::Rcout);
 
     Element response = msg.asElement(); 		// view as element
@@ -177,14 +171,9 @@ Rcpp::DataFrame bsrch_Impl(SEXP con,
                            std::string limit,
                            bool verbose=false) {
 #if defined(HaveBlp)
-    Session* session = reinterpret_cast<Session*>(checkExternalPointer(con, "blpapi::Session*"));
-
-    const std::string exrsrv = "//blp/exrsvc";
-    if (!session->openService(exrsrv.c_str())) {
-        Rcpp::stop("Failed to open " + exrsrv);
-    }
+    ConnectionEngine engine(con);
 
-    Service exrService = session->getService(exrsrv.c_str());
+    Service exrService = engine->service("//blp/exrsvc");
     Request request = exrService.createRequest("ExcelGetGridRequest");
 
     request.getElement(Name{"Domain"}).setValue(domain.c_str());
@@ -192,36 +181,11 @@ Rcpp::DataFrame bsrch_Impl(SEXP con,
     // TODO - implement limit and other overrides
 
     if (verbose) Rcpp::Rcout <<"Sending Request: " << request << std::endl;
-    session->sendRequest(request);
-
-    DataFrame ans;
-
-    // Wait for events from Session
-    bool done = false;
-    while (!done) {
-        Event event = session->nextEvent();
-        if (event.eventType() == Event::PARTIAL_RESPONSE) {
-            if (verbose) Rcpp::Rcout << "Processing Partial Response" << std::endl;
-            ans = processBsrchResponse(event, verbose);
-        } else if (event.eventType() == Event::RESPONSE) {
-            if (verbose) Rcpp::Rcout << "Processing Response" << std::endl;
-            ans = processBsrchResponse(event, verbose);
-            done = true;
-        } else {
-            MessageIterator msgIter(event);
-            while (msgIter.next()) {
-                Message msg = msgIter.message();
-                if (event.eventType() == Event::SESSION_STATUS) {
-                    if (msg.messageType() == "SessionTerminated" ||
-                        msg.messageType() == "SessionStartupFailure") {
-                        done = true;
-                    }
-                }
-            }
-        }
-    }
+    std::vector<Message> responses = engine.request(request);
 
-    return ans;
+    // a partial response is superseded by those following it
+    if (responses.empty()) Rcpp::stop("No response received.");
+    return processBsrchResponse(responses.back(), verbose);
 #else // ie no Blp
     return Rcpp::DataFrame();
 #endif
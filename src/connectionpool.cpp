@@ -0,0 +1,184 @@
+// -*- mode: C++; c-indent-level: 4; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+//
+//  connectionpool.cpp -- several sessions balancing the requests of one connection
+//
+//  Copyright (C) 2026  Whit Armstrong and Dirk Eddelbuettel
+//
+//  This file is part of Rblpapi
+//
+//  Rblpapi is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  Rblpapi is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Rblpapi.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#if defined(HaveBlp)
+
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <blpapi_utils.h>
+#include <connectionpool.h>
+#include <finalizers.h>
+
+namespace bbg = BloombergLP::blpapi;
+
+void ConnectionPool::add(const std::string& host, int port, const bbg::SessionOptions& options,
+                         size_t threads) {
+    members_.push_back(Member{host, port, std::unique_ptr<EventRouter>(new EventRouter(options, threads))});
+}
+
+void ConnectionPool::start(int timeout) {
+    std::string error;
+    size_t running = 0;
+    for (auto& m : members_) {
+        try {
+            m.router->startAsync();
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+    }
+    for (auto& m : members_) {
+        try {
+            m.router->waitStarted(timeout);
+            ++running;
+        } catch (const std::exception& e) {
+            error = m.host + ":" + std::to_string(m.port) + ": " + e.what();
+        }
+    }
+    if (running == 0) {
+        throw std::runtime_error("No session of the pool could be started, last error: " + error);
+    }
+}
+
+void ConnectionPool::warmUp(const std::vector<std::string>& names, int timeout) {
+    for (auto& m : members_) {
+        if (m.router->up()) m.router->warmUp(names, timeout);
+    }
+}
+
+bool ConnectionPool::inRotation(const Member& m) const {
+    if (!m.router->up()) return false;
+    return m.router->failureStreak() < maxFailures || m.router->sinceFailure() >= retryAfter;
+}
+
+EventRouter& ConnectionPool::select(const std::string& key) {
+    std::vector<size_t> candidates;
+    for (size_t i = 0; i < members_.size(); ++i) {
+        if (inRotation(members_[i])) candidates.push_back(i);
+    }
+    if (candidates.empty()) {
+        // all of them failing, rather try those that are up than give up
+        for (size_t i = 0; i < members_.size(); ++i) {
+            if (members_[i].router->up()) candidates.push_back(i);
+        }
+    }
+    if (candidates.empty()) {
+        throw std::runtime_error("No session of the pool is up.");
+    }
+    if (balance == Security && !key.empty()) {
+        return *members_[candidates[std::hash<std::string>{}(key) % candidates.size()]].router;
+    }
+    // fewest outstanding requests, round robin among equals
+    const size_t offset = next++;
+    size_t best = candidates[offset % candidates.size()];
+    size_t fewest = members_[best].router->pending();
+    for (size_t k = 1; k < candidates.size(); ++k) {
+        const size_t i = candidates[(offset + k) % candidates.size()];
+        const size_t n = members_[i].router->pending();
+        if (n < fewest) {
+            best = i;
+            fewest = n;
+        }
+    }
+    return *members_[best].router;
+}
+
+ConnectionPool* poolFromConnection(SEXP con_) {
+    if (TYPEOF(con_) != EXTPTRSXP || R_ExternalPtrTag(con_) == R_NilValue) return nullptr;
+    if (std::strcmp(CHAR(PRINTNAME(R_ExternalPtrTag(con_))), "Rblpapi::ConnectionPool*") != 0) return nullptr;
+    return reinterpret_cast<ConnectionPool*>(checkExternalPointer(con_, "Rblpapi::ConnectionPool*"));
+}
+
+static void poolFinalizer(SEXP pool_) {
+    ConnectionPool* pool = reinterpret_cast<ConnectionPool*>(R_ExternalPtrAddr(pool_));
+    if (pool) {
+        delete pool;
+        R_ClearExternalPtr(pool_);
+    }
+}
+#else
+#include <Rcpp/Lightest>
+#endif
+
+// [[Rcpp::export]]
+SEXP blpConnectPool_Impl(std::vector<std::string> hosts, std::vector<int> ports, SEXP app_name_,
+                         SEXP app_identity_key_, int threads, std::string balance, int maxFailures,
+                         double retryAfter, std::vector<std::string> services, int timeout) {
+#if defined(HaveBlp)
+    if (hosts.empty() || hosts.size() != ports.size()) {
+        Rcpp::stop("Need as many ports as hosts.");
+    }
+    ConnectionPool* pool = new ConnectionPool(balance == "security" ? ConnectionPool::Security
+                                                                    : ConnectionPool::Outstanding,
+                                              static_cast<unsigned>(std::max(maxFailures, 1)), retryAfter);
+    SEXP pool_ = Rcpp::Shield<SEXP>(createExternalPointer<ConnectionPool>(pool, poolFinalizer,
+                                                                          "Rblpapi::ConnectionPool*"));
+    try {
+        for (size_t i = 0; i < hosts.size(); ++i) {
+            pool->add(hosts[i], ports[i], createSessionOptions(hosts[i], ports[i], app_name_, app_identity_key_),
+                      threads);
+        }
+        pool->start(timeout);
+        pool->warmUp(services, timeout);
+    } catch (const std::exception& e) {
+        Rcpp::stop(e.what());
+    }
+    return pool_;
+#else // ie no Blp
+    return R_NilValue;
+#endif
+}
+
+// [[Rcpp::export]]
+Rcpp::DataFrame poolStatus_Impl(SEXP con_) {
+#if defined(HaveBlp)
+    ConnectionPool* pool =
+        reinterpret_cast<ConnectionPool*>(checkExternalPointer(con_, "Rblpapi::ConnectionPool*"));
+    const std::vector<ConnectionPool::Member>& members = pool->members();
+    const size_t n = members.size();
+    std::vector<std::string> host(n);
+    std::vector<int> port(n), pending(n), failures(n);
+    std::vector<double> sent(n);
+    std::vector<bool> up(n), inRotation(n);
+    for (size_t i = 0; i < n; ++i) {
+        const EventRouter& r = *members[i].router;
+        host[i] = members[i].host;
+        port[i] = members[i].port;
+        up[i] = r.up();
+        inRotation[i] = pool->inRotation(members[i]);
+        pending[i] = static_cast<int>(r.pending());
+        sent[i] = static_cast<double>(r.sent());
+        failures[i] = static_cast<int>(r.failureStreak());
+    }
+    return Rcpp::DataFrame::create(Rcpp::Named("host") = host,
+                                   Rcpp::Named("port") = port,
+                                   Rcpp::Named("up") = up,
+                                   Rcpp::Named("inRotation") = inRotation,
+                                   Rcpp::Named("pending") = pending,
+                                   Rcpp::Named("sent") = sent,
+                                   Rcpp::Named("failures") = failures,
+                                   Rcpp::Named("stringsAsFactors") = false);
+#else // ie no Blp
+    return Rcpp::DataFrame();
+#endif
+}
@@ -0,0 +1,73 @@
+// -*- mode: C++; c-indent-level: 4; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+//
+//  connectionpool.h -- several sessions balancing the requests of one connection
+//
+//  Copyright (C) 2026  Whit Armstrong and Dirk Eddelbuettel
+//
+//  This file is part of Rblpapi
+//
+//  Rblpapi is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  Rblpapi is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Rblpapi.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <blpapi_sessionoptions.h>
+#include <eventrouter.h>
+
+// A connection made of several asynchronous sessions, possibly to different
+// hosts, each an EventRouter. Every call is given to one of them, either the
+// one with the fewest outstanding requests or one chosen by a hash of its
+// security, so that related requests share a session. A session whose
+// requests the server failed several times in a row, or which is down, is
+// taken out of rotation; a failing one is tried again after a while.
+class ConnectionPool {
+public:
+    enum Balance { Outstanding, Security };
+
+    struct Member {
+        std::string host;
+        int port;
+        std::unique_ptr<EventRouter> router;
+    };
+
+    ConnectionPool(Balance balance, unsigned maxFailures, double retryAfter)
+        : balance(balance), maxFailures(maxFailures), retryAfter(retryAfter) {}
+
+    // R thread; sessions are started all at once, and the pool fails only
+    // if none of them comes up; throws std::runtime_error
+    void add(const std::string& host, int port, const BloombergLP::blpapi::SessionOptions& options,
+             size_t threads);
+    void start(int timeout);
+    // open services on all sessions that are up, see EventRouter::warmUp
+    void warmUp(const std::vector<std::string>& names, int timeout);
+
+    // the session for a call, keyed by its security if balanced by security
+    EventRouter& select(const std::string& key);
+    bool inRotation(const Member& m) const;
+    const std::vector<Member>& members() const { return members_; }
+
+private:
+    Balance balance;
+    unsigned maxFailures;               // failures in a row taking a session out of rotation
+    double retryAfter;                  // seconds after which a failing session is tried again
+    std::vector<Member> members_;
+    std::atomic<size_t> next{0};        // breaks ties between equally loaded sessions
+};
+
+// the pool behind a connection object, or nullptr
+ConnectionPool* poolFromConnection(SEXP con_);
@@ -0,0 +1,250 @@
+// -*- mode: C++; c-indent-level: 4; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+//
+//  eventrouter.cpp -- asynchronous session routing request events by correlation id
+//
+//  Copyright (C) 2026  Whit Armstrong and Dirk Eddelbuettel
+//
+//  This file is part of Rblpapi
+//
+//  Rblpapi is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  Rblpapi is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Rblpapi.  If not, see <http://www.gnu.org/licenses/>.
+
+#if defined(HaveBlp)
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <blpapi_exception.h>
+#include <blpapi_utils.h>
+#include <eventrouter.h>
+#include <finalizers.h>
+
+namespace bbg = BloombergLP::blpapi;
+
+namespace {
+    const bbg::Name SERVICE_OPENED("ServiceOpened");
+    const bbg::Name SERVICE_OPEN_FAILURE("ServiceOpenFailure");
+
+    struct RequestHandle {
+        RequestEngine* router;          // kept alive by the connection protected by the handle
+        std::shared_ptr<RequestState> state;
+    };
+
+    void requestHandleFinalizer(SEXP handle_) {
+        // the router is left alone here, it may already have been finalized
+        RequestHandle* h = reinterpret_cast<RequestHandle*>(R_ExternalPtrAddr(handle_));
+        if (h) {
+            delete h;
+            R_ClearExternalPtr(handle_);
+        }
+    }
+
+    RequestHandle* requestHandle(SEXP handle_) {
+        return reinterpret_cast<RequestHandle*>(checkExternalPointer(handle_, "Rblpapi::RequestHandle*"));
+    }
+}
+
+EventRouter::EventRouter(const bbg::SessionOptions& sessionOptions, size_t threads)
+    : RequestEngine(Starting, &context.throttle()), threads_(std::max<size_t>(threads, 1)), dispatcher(threads_) {
+    dispatcher.start();
+    session.reset(new bbg::Session(sessionOptions, this, &dispatcher));
+}
+
+EventRouter::~EventRouter() {
+    try {
+        // blocks until the dispatcher threads have delivered their last event
+        session->stop();
+        dispatcher.stop();
+    } catch (...) {
+        // nothing sensible left to do
+    }
+    failAll("Session stopped.");
+}
+
+void EventRouter::start(int timeout) {
+    startAsync();
+    waitStarted(timeout);
+}
+
+void EventRouter::startAsync() {
+    if (!session->startAsync()) {
+        throw std::runtime_error("Failed to start session.");
+    }
+}
+
+void EventRouter::waitStarted(int timeout) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!started.wait_for(lock, std::chrono::milliseconds(timeout), [this]() { return sessionState != Starting; })) {
+        throw std::runtime_error("Timed out starting session.");
+    }
+    if (sessionState != Running) {
+        throw std::runtime_error("Failed to start session.");
+    }
+}
+
+bbg::Service EventRouter::service(const std::string& name) {
+    // openService() blocks on the events it waits for, which the dispatcher
+    // threads deliver, so it must not be called with the lock held
+    return context.open(*session, name);
+}
+
+std::vector<std::string> EventRouter::warmUp(const std::vector<std::string>& names, int timeout) {
+    for (const auto& name : names) {
+        bbg::Service s;
+        if (context.find(name, s)) continue;
+        const long long id = newCorrelationId();
+        {
+            // registered first, the status may arrive before openServiceAsync returns
+            std::lock_guard<std::mutex> lock(mutex);
+            opening.emplace(id, name);
+        }
+        session->openServiceAsync(name.c_str(), bbg::CorrelationId(id));
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    opened.wait_for(lock, std::chrono::milliseconds(timeout), [this]() { return opening.empty(); });
+    std::vector<std::string> failed;
+    failed.swap(openFailures);
+    for (const auto& o : opening) failed.push_back(o.second);
+    opening.clear();
+    return failed;
+}
+
+void EventRouter::sendRequest(const bbg::Request& request, const bbg::CorrelationId& cid,
+                              const bbg::Identity* identity) {
+    if (identity != nullptr) {
+        session->sendRequest(request, *identity, cid);
+    } else {
+        session->sendRequest(request, cid);
+    }
+}
+
+void EventRouter::cancelRequest(const bbg::CorrelationId& cid) {
+    session->cancel(cid);
+}
+
+bool EventRouter::waitFor(const std::shared_ptr<RequestState>& state, int timeout) {
+    return state->wait(timeout);
+}
+
+bool EventRouter::processEvent(const bbg::Event& event, bbg::Session*) {
+    // nothing may escape into the dispatcher
+    try {
+        if (event.eventType() == bbg::Event::SERVICE_STATUS) {
+            onServiceStatus(event);
+        } else {
+            route(event);
+        }
+    } catch (...) {
+        // a message that cannot be routed has no request to fail
+    }
+    return true;
+}
+
+void EventRouter::onServiceStatus(const bbg::Event& event) {
+    bbg::MessageIterator msgIter(event);
+    while (msgIter.next()) {
+        bbg::Message msg = msgIter.message();
+        const bool ok = msg.messageType() == SERVICE_OPENED;
+        if (!ok && msg.messageType() != SERVICE_OPEN_FAILURE) continue;
+        std::string name;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = opening.find(msg.correlationId().asInteger());
+            if (it == opening.end()) continue;      // opened by openService()
+            name = it->second;
+            if (!ok) {
+                openFailures.push_back(name);
+                opening.erase(it);
+                opened.notify_all();
+                continue;
+            }
+        }
+        // the service is known to the session once opened
+        context.add(name, session->getService(name.c_str()));
+        std::lock_guard<std::mutex> lock(mutex);
+        opening.erase(msg.correlationId().asInteger());
+        opened.notify_all();
+    }
+}
+
+EventRouter* routerFromConnection(SEXP con_) {
+    if (TYPEOF(con_) != EXTPTRSXP || R_ExternalPtrTag(con_) == R_NilValue) return nullptr;
+    if (std::strcmp(CHAR(PRINTNAME(R_ExternalPtrTag(con_))), "Rblpapi::EventRouter*") != 0) return nullptr;
+    return reinterpret_cast<EventRouter*>(checkExternalPointer(con_, "Rblpapi::EventRouter*"));
+}
+
+SEXP createRequestHandle(SEXP con_, RequestEngine& engine, std::shared_ptr<RequestState> state) {
+    RequestHandle* h = new RequestHandle{&engine, state};
+    SEXP handle_ = Rcpp::Shield<SEXP>(createExternalPointer<RequestHandle>(h, requestHandleFinalizer,
+                                                                           "Rblpapi::RequestHandle*"));
+    R_SetExternalPtrProtected(handle_, con_);
+    return handle_;
+}
+
+#else
+#include <Rcpp/Lightest>
+#endif
+
+// [[Rcpp::export]]
+Rcpp::List requestStatus_Impl(SEXP handle_) {
+#if defined(HaveBlp)
+    RequestHandle* h = requestHandle(handle_);
+    const char* statusNames[] = { "pending", "complete", "failed", "cancelled" };
+    return Rcpp::List::create(Rcpp::Named("status") = statusNames[h->state->status()],
+                              Rcpp::Named("requests") = static_cast<double>(h->state->requests()),
+                              Rcpp::Named("messages") = static_cast<double>(h->state->messages()),
+                              Rcpp::Named("elapsed") = h->state->elapsed(),
+                              Rcpp::Named("error") = h->state->error());
+#else // ie no Blp
+    return Rcpp::List();
+#endif
+}
+
+// [[Rcpp::export]]
+bool waitRequest_Impl(SEXP handle_, int timeout) {
+#if defined(HaveBlp)
+    RequestHandle* h = requestHandle(handle_);
+    // in short slices so that interrupts are seen, which leave the request running
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+    while (!h->state->wait(timeout > 0 ? std::min(timeout, 100) : 100)) {
+        Rcpp::checkUserInterrupt();
+        if (timeout > 0 && std::chrono::steady_clock::now() >= deadline) return false;
+    }
+    return true;
+#else // ie no Blp
+    return false;
+#endif
+}
+
+// [[Rcpp::export]]
+SEXP cancelRequest_Impl(SEXP handle_) {
+#if defined(HaveBlp)
+    RequestHandle* h = requestHandle(handle_);
+    if (h->state->status() == RequestState::Pending) {
+        h->router->cancel(h->state);
+    }
+#endif
+    return R_NilValue;
+}
+
+// [[Rcpp::export]]
+SEXP collectRequest_Impl(SEXP handle_) {
+#if defined(HaveBlp)
+    RequestHandle* h = requestHandle(handle_);
+    h->router->await(h->state);
+    return h->state->materialize();
+#else // ie no Blp
+    return R_NilValue;
+#endif
+}
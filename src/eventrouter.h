@@ -0,0 +1,85 @@
+// -*- mode: C++; c-indent-level: 4; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+//
+//  eventrouter.h -- asynchronous session routing request events by correlation id
+//
+//  Copyright (C) 2026  Whit Armstrong and Dirk Eddelbuettel
+//
+//  This file is part of Rblpapi
+//
+//  Rblpapi is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  Rblpapi is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Rblpapi.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <blpapi_event.h>
+#include <blpapi_eventdispatcher.h>
+#include <blpapi_service.h>
+#include <blpapi_session.h>
+#include <blpapi_sessionoptions.h>
+#include <requestengine.h>
+
+// Owns an asynchronous session whose events are handled by a pool of blpapi
+// dispatcher threads, which route them and decode the responses, so that
+// requests are decoded off the R thread and can be waited for from any
+// thread. Services are opened from the R thread, never from a dispatcher
+// thread.
+class EventRouter : public RequestEngine, public BloombergLP::blpapi::EventHandler {
+public:
+    EventRouter(const BloombergLP::blpapi::SessionOptions& sessionOptions, size_t threads);
+    ~EventRouter();
+
+    // R thread; start blocks until the session is up, as does
+    // waitStarted after startAsync, all throw std::runtime_error
+    void start(int timeout);
+    void startAsync();
+    void waitStarted(int timeout);
+    BloombergLP::blpapi::Service service(const std::string& name) override;
+    // R thread; open services with openServiceAsync(), waiting up to
+    // 'timeout' milliseconds, and return those not opened
+    std::vector<std::string> warmUp(const std::vector<std::string>& names, int timeout);
+
+    size_t threads() const { return threads_; }
+
+    // dispatcher threads
+    bool processEvent(const BloombergLP::blpapi::Event& event,
+                      BloombergLP::blpapi::Session* session) override;
+
+protected:
+    void sendRequest(const BloombergLP::blpapi::Request& request,
+                     const BloombergLP::blpapi::CorrelationId& cid,
+                     const BloombergLP::blpapi::Identity* identity) override;
+    void cancelRequest(const BloombergLP::blpapi::CorrelationId& cid) override;
+    bool waitFor(const std::shared_ptr<RequestState>& state, int timeout) override;
+
+private:
+    void onServiceStatus(const BloombergLP::blpapi::Event& event);
+
+    size_t threads_;
+    BloombergLP::blpapi::EventDispatcher dispatcher;
+    std::unique_ptr<BloombergLP::blpapi::Session> session;
+    SessionContext context;
+    std::unordered_map<long long, std::string> opening;     // guarded by mutex
+    std::vector<std::string> openFailures;                  // idem
+    std::condition_variable opened;
+};
+
+// the router behind a connection object, or nullptr for a synchronous session
+EventRouter* routerFromConnection(SEXP con_);
+
+// R handle of a state submitted through an engine of a connection, which the
+// handle keeps alive
+SEXP createRequestHandle(SEXP con_, RequestEngine& engine, std::shared_ptr<RequestState> state);
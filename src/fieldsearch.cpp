@@ -45,6 +45,7 @@
 #if defined(HaveBlp)
 #include <blpapi_session.h>
 #include <blpapi_utils.h>
+#include <requestengine.h>
 namespace bbg = BloombergLP::blpapi;	// shortcut to not globally import both namespace
 
 namespace {
@@ -64,56 +65,34 @@ namespace {
 Rcpp::DataFrame fieldSearch_Impl(SEXP con, std::string searchterm) {
 #if defined(HaveBlp)
     // via Rcpp Attributes we get a try/catch block with error propagation to R "for free"
-    bbg::Session* session =
-        reinterpret_cast<bbg::Session*>(checkExternalPointer(con,"blpapi::Session*"));
+    ConnectionEngine engine(con);
 
-    const char *APIFLDS_SVC = "//blp/apiflds";
-    if (!session->openService(APIFLDS_SVC)) {
-        Rcpp::stop("Failed to open service");
-    }
-
-    bbg::Service fieldInfoService = session->getService(APIFLDS_SVC);
+    bbg::Service fieldInfoService = engine->service("//blp/apiflds");
     bbg::Request request = fieldInfoService.createRequest("FieldSearchRequest");
     request.set(bbg::Name{"searchSpec"}, searchterm.c_str());
     request.set(bbg::Name{"returnFieldDocumentation"}, false);
-    session->sendRequest(request);
 
     std::vector<std::string> fieldId, fieldMnen, fieldDesc;
-    while (true) {
-        bbg::Event event = session->nextEvent();
-
-        if (event.eventType() != bbg::Event::RESPONSE &&
-            event.eventType() != bbg::Event::PARTIAL_RESPONSE) {
-            continue;
-        }
-
-        bbg::MessageIterator msgIter(event);
-        while (msgIter.next()) {
-            bbg::Message msg = msgIter.message();
-            bbg::Element fields = msg.getElement(bbg::Name{"fieldData"});
-            int numElements = fields.numValues();
-            //Rprintf("Seeing %d elements\n", numElements);
-            for (int i=0; i < numElements; i++) {
-                const bbg::Element fld = fields.getValueAsElement(i);
-                std::string  fldId = fld.getElementAsString(FIELD_ID);
-                if (fld.hasElement(FIELD_INFO)) {
-                    bbg::Element fldInfo     = fld.getElement (FIELD_INFO) ;
-                    std::string  fldMnemonic = fldInfo.getElementAsString(FIELD_MNEMONIC);
-                    std::string  fldDesc     = fldInfo.getElementAsString(FIELD_DESC);
-                    fieldId.push_back(fldId);
-                    fieldMnen.push_back(fldMnemonic);
-                    fieldDesc.push_back(fldDesc);
-                }
-                else {
-                    bbg::Element fldError = fld.getElement(FIELD_ERROR) ;
-                    std::string  errorMsg = fldError.getElementAsString(FIELD_MSG) ;
-                    Rcpp::stop(errorMsg);
-                }
+    for (const bbg::Message& msg : engine.request(request)) {
+        bbg::Element fields = msg.getElement(FIELD_DATA);
+        int numElements = fields.numValues();
+        //Rprintf("Seeing %d elements\n", numElements);
+        for (int i=0; i < numElements; i++) {
+            const bbg::Element fld = fields.getValueAsElement(i);
+            std::string  fldId = fld.getElementAsString(FIELD_ID);
+            if (fld.hasElement(FIELD_INFO)) {
+                bbg::Element fldInfo     = fld.getElement (FIELD_INFO) ;
+                std::string  fldMnemonic = fldInfo.getElementAsString(FIELD_MNEMONIC);
+                std::string  fldDesc     = fldInfo.getElementAsString(FIELD_DESC);
+                fieldId.push_back(fldId);
+                fieldMnen.push_back(fldMnemonic);
+                fieldDesc.push_back(fldDesc);
+            }
+            else {
+                bbg::Element fldError = fld.getElement(FIELD_ERROR) ;
+                std::string  errorMsg = fldError.getElementAsString(FIELD_MSG) ;
+                Rcpp::stop(errorMsg);
             }
-
-        }
-        if (event.eventType() == bbg::Event::RESPONSE) {
-            break;
         }
     }
     return Rcpp::DataFrame::create(Rcpp::Named("Id")          = fieldId,
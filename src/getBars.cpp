@@ -59,7 +59,11 @@
 #include <string>
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
+#include <cmath>
 #include <blpapi_utils.h>
+#include <requestengine.h>
+#include <bars.h>
 
 namespace bbg = BloombergLP::blpapi;	// shortcut to not globally import both namespace
 
@@ -74,23 +78,11 @@ namespace {
     const bbg::Name NUM_EVENTS("numEvents");
     const bbg::Name TIME("time");
     const bbg::Name RESPONSE_ERROR("responseError");
-    const bbg::Name SESSION_TERMINATED("SessionTerminated");
     const bbg::Name CATEGORY("category");
     //const bbg::Name MESSAGE("message"); // for some reason this does not compile
     const bbg::Name VALUE("value");
 }
 
-struct Bars {
-    std::vector<double> time;     // to be converted to POSIXct later
-    std::vector<double> open;
-    std::vector<double> high;
-    std::vector<double> low;
-    std::vector<double> close;
-    std::vector<int> numEvents;
-    std::vector<double> volume;   // instread of long long
-    std::vector<double> value;   // instread of long long
-};
-
 void processMessage(bbg::Message &msg, Bars &bars,
                     const int barInterval, const bool verbose) {
     bbg::Element data = msg.getElement(BAR_DATA).getElement(BAR_TICK_DATA);
@@ -128,29 +120,87 @@ void processMessage(bbg::Message &msg, Bars &bars,
                         << volume << "\t\t"
                         << value << std::endl;
         }
-        bars.time.push_back(bbgDatetimeToUTC(time));
-        bars.open.push_back(open);
-        bars.high.push_back(high);
-        bars.low.push_back(low);
-        bars.close.push_back(close);
-        bars.numEvents.push_back(numEvents);
-        bars.volume.push_back(volume);
-        bars.value.push_back(value);
+        bars.push_back(bbgDatetimeToUTC(time), open, high, low, close, numEvents, volume, value);
     }
 }
 
-void processResponseEvent(bbg::Event &event, Bars &bars,
-                          const int barInterval, const bool verbose) {
-    bbg::MessageIterator msgIter(event);
-    while (msgIter.next()) {
-        bbg::Message msg = msgIter.message();
+std::shared_ptr<BufferedRequestState> sendBarRequest(ConnectionEngine& engine, const std::string& security,
+                                                     const std::string& eventType, const int barInterval,
+                                                     const std::string& startDateTime, const std::string& endDateTime,
+                                                     SEXP options, const bool verbose) {
+    bbg::Service refDataService = engine->service("//blp/refdata");
+    bbg::Request request = refDataService.createRequest("IntradayBarRequest");
+
+    // only one security/eventType per request
+    request.set(bbg::Name{"security"}, security.c_str());
+    request.set(bbg::Name{"eventType"}, eventType.c_str());
+    request.set(bbg::Name{"interval"}, barInterval);
+
+    request.set(bbg::Name{"startDateTime"}, startDateTime.c_str());
+    request.set(bbg::Name{"endDateTime"}, endDateTime.c_str());
+    if (options != R_NilValue) {
+        appendOptionsToRequest(request, options);
+    }
+
+    if (verbose) Rcpp::Rcout <<"Sending Request: " << request << std::endl;
+    auto state = std::make_shared<BufferedRequestState>();
+    engine->send(request, state);
+    return state;
+}
+
+bool collectBars(ConnectionEngine& engine, const std::shared_ptr<BufferedRequestState>& state,
+                 const int barInterval, const bool verbose, Bars& bars) {
+    engine->await(state);
+    bool clean = true;
+    std::vector<bbg::Message> responses = state->responses();
+    for (bbg::Message& msg : responses) {
         if (msg.hasElement(RESPONSE_ERROR)) {
             Rcpp::Rcerr << "REQUEST FAILED: " << msg.getElement(RESPONSE_ERROR) << std::endl;
+            clean = false;
             continue;
         }
         processMessage(msg, bars, barInterval, verbose);
     }
+    return clean;
 }
+
+Rcpp::DataFrame barsToDataFrame(const Bars& bars) {
+    return Rcpp::DataFrame::create(Rcpp::Named("times")     = createPOSIXtVector(bars.time),
+                                   Rcpp::Named("open")      = bars.open,
+                                   Rcpp::Named("high")      = bars.high,
+                                   Rcpp::Named("low")       = bars.low,
+                                   Rcpp::Named("close")     = bars.close,
+                                   Rcpp::Named("numEvents") = bars.numEvents,
+                                   Rcpp::Named("volume")    = bars.volume,
+                                   Rcpp::Named("value")     = bars.value);
+}
+
+// seconds since epoch to the 'YYYY-MM-DDTHH:MM:SS' UTC format used in requests
+std::string posixToRequestString(const double t) {
+    time_t tt = static_cast<time_t>(t);
+    char txt[32];
+    strftime(txt, sizeof(txt), "%Y-%m-%dT%H:%M:%S", gmtime(&tt));
+    return std::string(txt);
+}
+
+// canonical form of the request options so that equivalent requests share a cache entry
+std::string optionsToKey(SEXP options_) {
+    if (options_ == R_NilValue) return std::string();
+    Rcpp::CharacterVector options(options_);
+    if (!options.hasAttribute("names")) {
+        Rcpp::stop("Request options must be named.");
+    }
+    Rcpp::CharacterVector options_names(options.attr("names"));
+    std::vector<std::string> kv;
+    for (R_len_t i = 0; i < options.length(); i++) {
+        kv.push_back(static_cast<std::string>(options_names[i]) + "=" + static_cast<std::string>(options[i]));
+    }
+    std::sort(kv.begin(), kv.end());
+    return vectorToCSVString(kv);
+}
+
+// process-wide, shared by all connections as the data does not depend on the session
+static BarCache barCache;
 #else
 #include <Rcpp/Lightest>
 #endif
@@ -166,66 +216,113 @@ Rcpp::DataFrame getBars_Impl(SEXP con,
                              bool verbose=false) {
 #if defined(HaveBlp)
     // via Rcpp Attributes we get a try/catch block with error propagation to R "for free"
-    bbg::Session* session =
-        reinterpret_cast<bbg::Session*>(checkExternalPointer(con,"blpapi::Session*"));
+    ConnectionEngine engine(con, security);
 
-    if (!session->openService("//blp/refdata")) {
-        Rcpp::stop("Failed to open //blp/refdata");
-    }
-
-    bbg::Service refDataService = session->getService("//blp/refdata");
-    bbg::Request request = refDataService.createRequest("IntradayBarRequest");
+    Bars bars;
+    collectBars(engine, sendBarRequest(engine, security, eventType, barInterval, startDateTime, endDateTime,
+                                       options, verbose),
+                barInterval, verbose, bars);
+    return barsToDataFrame(bars);
+#else // ie no Blp
+    return Rcpp::DataFrame();
+#endif
 
-    // only one security/eventType per request
-    request.set(bbg::Name{"security"}, security.c_str());
-    request.set(bbg::Name{"eventType"}, eventType.c_str());
-    request.set(bbg::Name{"interval"}, barInterval);
+}
 
-    request.set(bbg::Name{"startDateTime"}, startDateTime.c_str());
-    request.set(bbg::Name{"endDateTime"}, endDateTime.c_str());
-    if (options.isNotNull()) {
-        appendOptionsToRequest(request, options);
+// Bars are served from the local cache where possible. The window is widened to
+// whole multiples of the bar interval; completed bars are cached, coarser bars are
+// derived from cached finer bars, and only the remaining gaps are requested.
+//
+// [[Rcpp::export]]
+Rcpp::DataFrame getBarsCached_Impl(SEXP con,
+                                   std::string security,
+                                   std::string eventType,
+                                   int barInterval,
+                                   double startTime,
+                                   double endTime,
+                                   Rcpp::Nullable<Rcpp::CharacterVector> options,
+                                   bool verbose=false) {
+#if defined(HaveBlp)
+    if (barInterval <= 0) {
+        Rcpp::stop("Bar interval must be positive.");
     }
+    const double width = barInterval * 60.0;
+    const double start = std::floor(startTime / width) * width;
+    const double end = std::ceil(endTime / width) * width;
 
-    if (verbose) Rcpp::Rcout <<"Sending Request: " << request << std::endl;
-    session->sendRequest(request);
+    // bars opening before this point in time can no longer change
+    const double complete = std::floor(static_cast<double>(time(NULL)) / width) * width;
 
-    Bars bars;
+    BarKey key{security, eventType, optionsToKey(options), barInterval};
+    BarSeries& series = barCache.series(key);
+
+    const double split = std::min(end, complete);
+    if (split > start && !series.covers(start, split)) {
+        int fineInterval = 0;
+        const BarSeries* fine = barCache.finerSeries(key, start, split, fineInterval);
+        if (fine != nullptr) {
+            if (verbose) Rcpp::Rcout << "Deriving " << barInterval << " minute bars from cached "
+                                     << fineInterval << " minute bars" << std::endl;
+            Bars fineBars, coarseBars;
+            fine->extract(start, split, fineBars);
+            aggregateBars(fineBars, barInterval, coarseBars);
+            series.insert(coarseBars);
+            series.markCovered(start, split);
+        }
+    }
 
-    // eventLoop
-    bool done = false;
-    while (!done) {
-        bbg::Event event = session->nextEvent();
-        if (event.eventType() == bbg::Event::PARTIAL_RESPONSE) {
-            if (verbose) Rcpp::Rcout << "Processing Partial Response" << std::endl;
-            processResponseEvent(event, bars, barInterval, verbose);
-        } else if (event.eventType() == bbg::Event::RESPONSE) {
-            if (verbose) Rcpp::Rcout << "Processing Response" << std::endl;
-            processResponseEvent(event, bars, barInterval, verbose);
-            done = true;
-        } else {
-            bbg::MessageIterator msgIter(event);
-            while (msgIter.next()) {
-                bbg::Message msg = msgIter.message();
-                if (event.eventType() == bbg::Event::SESSION_STATUS) {
-                    if (msg.messageType() == SESSION_TERMINATED) {
-                        done = true;
-                    }
-                }
+    std::vector<std::pair<double,double>> gaps = series.gaps(start, end);
+    if (!gaps.empty()) {
+        // all gaps are requested at once and collected in order
+        ConnectionEngine engine(con, security);
+        std::vector<std::shared_ptr<BufferedRequestState>> states;
+        for (const auto& gap : gaps) {
+            states.push_back(sendBarRequest(engine, security, eventType, barInterval,
+                                            posixToRequestString(gap.first), posixToRequestString(gap.second),
+                                            options, verbose));
+        }
+        // the cache is only updated once every gap has been filled without
+        // errors, so that a failed request is sent again by the next call
+        std::vector<Bars> fetched(gaps.size());
+        bool clean = true;
+        try {
+            for (size_t i = 0; i < gaps.size(); ++i) {
+                clean = collectBars(engine, states[i], barInterval, verbose, fetched[i]) && clean;
             }
+        } catch (...) {
+            for (const auto& state : states) engine->cancel(state);
+            throw;
+        }
+        if (!clean) {
+            Rcpp::stop("Bar request for '" + security + "' failed, the window is not cached.");
+        }
+        for (size_t i = 0; i < gaps.size(); ++i) {
+            series.insert(fetched[i]);
+            series.markCovered(gaps[i].first, std::min(gaps[i].second, complete));
         }
+    } else if (verbose) {
+        Rcpp::Rcout << "Serving all bars from cache" << std::endl;
     }
 
-    return Rcpp::DataFrame::create(Rcpp::Named("times")     = createPOSIXtVector(bars.time),
-                                   Rcpp::Named("open")      = bars.open,
-                                   Rcpp::Named("high")      = bars.high,
-                                   Rcpp::Named("low")       = bars.low,
-                                   Rcpp::Named("close")     = bars.close,
-                                   Rcpp::Named("numEvents") = bars.numEvents,
-                                   Rcpp::Named("volume")    = bars.volume,
-                                   Rcpp::Named("value")     = bars.value);
+    Bars bars;
+    series.extract(start, end, bars);
+    return barsToDataFrame(bars);
 #else // ie no Blp
     return Rcpp::DataFrame();
 #endif
+}
 
+// [[Rcpp::export]]
+SEXP clearBarCache_Impl(SEXP security_) {
+#if defined(HaveBlp)
+    if (security_ == R_NilValue) {
+        barCache.clear();
+    } else {
+        std::vector<std::string> securities(Rcpp::as< std::vector<std::string> >(security_));
+        for (const auto& s : securities) {
+            barCache.clear(s);
+        }
+    }
+#endif
+    return R_NilValue;
 }
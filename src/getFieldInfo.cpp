@@ -17,13 +17,12 @@
 
 #if defined(HaveBlp)
 #include <blpapi_utils.h>
-using BloombergLP::blpapi::Session;
+#include <requestengine.h>
 using BloombergLP::blpapi::Service;
 using BloombergLP::blpapi::Request;
-using BloombergLP::blpapi::Event;
 using BloombergLP::blpapi::Message;
-using BloombergLP::blpapi::MessageIterator;
 using BloombergLP::blpapi::Element;
+using BloombergLP::blpapi::Name;
 #else
 #include <Rcpp/Lightest>
 #endif
@@ -31,10 +30,24 @@ using BloombergLP::blpapi::Element;
 // [[Rcpp::export]]
 Rcpp::List fieldInfo_Impl(SEXP con_, std::vector<std::string> fields) {
 #if defined(HaveBlp)
-    Session* session = reinterpret_cast<Session*>(checkExternalPointer(con_, "blpapi::Session*"));
+    ConnectionEngine engine(con_);
 
-    // get the field info
-    std::vector<FieldInfo> fldinfos(getFieldTypes(session, fields));
+    // get the field info, all in one request
+    Request request = engine->service("//blp/apiflds").createRequest("FieldInfoRequest");
+    for (const auto& f : fields) {
+        request.append(Name{"id"}, f.c_str());
+    }
+    request.set(Name{"returnFieldDocumentation"}, false);
+    std::vector<FieldInfo> fldinfos;
+    for (const Message& msg : engine.request(request)) {
+        Element fieldData = msg.getElement(Name{"fieldData"});
+        for (size_t i = 0; i < fieldData.numValues(); ++i) {
+            fldinfos.push_back(fieldInfoFromElement(fieldData.getValueAsElement(i)));
+        }
+    }
+    if (fldinfos.size() != fields.size()) {
+        Rcpp::stop("fieldInfo: unexpected number of fields returned.");
+    }
     std::vector<std::string> colnames {"id","mnemonic","datatype","ftype"};
     std::vector<RblpapiT> res_types(4,RblpapiT::String);
     Rcpp::List res(allocateDataFrame(fields, colnames, res_types));
@@ -63,6 +63,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <blpapi_utils.h>
+#include <requestengine.h>
 
 namespace bbg = BloombergLP::blpapi;	// shortcut to not globally import both namespaces
 
@@ -76,7 +77,6 @@ namespace {
     const bbg::Name RESPONSE_ERROR("responseError");
     const bbg::Name CATEGORY("category");
     //const bbg::Name MESSAGE("message"); // for some reason this does not compile
-    const bbg::Name SESSION_TERMINATED("SessionTerminated");
 }
 
 struct Ticks {
@@ -121,39 +121,60 @@ void processMessage(bbg::Message &msg, Ticks &ticks, const bool verbose) {
     }
 }
 
-void processResponseEvent(bbg::Event &event, Ticks &ticks, const bool verbose) {
-    bbg::MessageIterator msgIter(event);
-    while (msgIter.next()) {
-        bbg::Message msg = msgIter.message();
-        if (msg.hasElement(RESPONSE_ERROR)) {
-            Rcpp::Rcerr << "REQUEST FAILED: " << msg.getElement(RESPONSE_ERROR) << std::endl;
-            continue;
-        }
-        processMessage(msg, ticks, verbose);
-    }
-}
-#else
-#include <Rcpp/Lightest>
-#endif
+// trades stamped with the bid and ask prevailing at the time of the trade; as
+// ticks arrive in time order a single pass suffices to perform the as-of join
+struct QuotedTrades {
+    std::vector<double> time;
+    std::vector<double> value;
+    std::vector<double> size;
+    std::vector<std::string> conditionCode;
+    std::vector<double> bid;
+    std::vector<double> bidSize;
+    std::vector<double> ask;
+    std::vector<double> askSize;
 
-// [[Rcpp::export]]
-Rcpp::DataFrame getTicks_Impl(SEXP con,
-                              std::string security,
-                              std::vector<std::string> eventType,
-                              std::string startDateTime,
-                              std::string endDateTime,
-                              bool setCondCodes=true,
-                              bool verbose=false) {
-#if defined(HaveBlp)
-    // via Rcpp Attributes we get a try/catch block with error propagation to R "for free"
-    bbg::Session* session =
-        reinterpret_cast<bbg::Session*>(checkExternalPointer(con,"blpapi::Session*"));
+    double curBid = NA_REAL, curBidSize = NA_REAL, curAsk = NA_REAL, curAskSize = NA_REAL;
+};
 
-    if (!session->openService("//blp/refdata")) {
-        Rcpp::stop("Failed to open //blp/refdata");
+void processMessage(bbg::Message &msg, QuotedTrades &trades, const bool verbose) {
+    bbg::Element data = msg.getElement(TICK_DATA).getElement(TICK_DATA);
+    int numItems = data.numValues();
+    if (verbose) {
+        Rcpp::Rcout <<"Response contains " << numItems << " items" << std::endl;
+    }
+    for (int i = 0; i < numItems; ++i) {
+        bbg::Element item = data.getValueAsElement(i);
+        const char* type = item.getElementAsString(TYPE);
+        if (std::strcmp(type, "TRADE") == 0) {
+            trades.time.push_back(bbgDatetimeToUTC(item.getElementAsDatetime(TIME)));
+            trades.value.push_back(item.getElementAsFloat64(VALUE));
+            trades.size.push_back(item.getElementAsInt32(TICK_SIZE));
+            trades.conditionCode.push_back(item.hasElement(COND_CODE) ? item.getElementAsString(COND_CODE) : "");
+            trades.bid.push_back(trades.curBid);
+            trades.bidSize.push_back(trades.curBidSize);
+            trades.ask.push_back(trades.curAsk);
+            trades.askSize.push_back(trades.curAskSize);
+        } else if (std::strcmp(type, "BID") == 0 || std::strcmp(type, "BEST_BID") == 0) {
+            trades.curBid = item.getElementAsFloat64(VALUE);
+            trades.curBidSize = item.getElementAsInt32(TICK_SIZE);
+        } else if (std::strcmp(type, "ASK") == 0 || std::strcmp(type, "BEST_ASK") == 0) {
+            trades.curAsk = item.getElementAsFloat64(VALUE);
+            trades.curAskSize = item.getElementAsInt32(TICK_SIZE);
+        }
     }
+}
 
-    bbg::Service refDataService = session->getService("//blp/refdata");
+// send an IntradayTickRequest and hand all responses to the given accumulator
+template <typename T>
+void runTickRequest(ConnectionEngine& engine,
+                    const std::string& security,
+                    const std::vector<std::string>& eventType,
+                    const std::string& startDateTime,
+                    const std::string& endDateTime,
+                    const bool setCondCodes,
+                    const bool verbose,
+                    T& acc) {
+    bbg::Service refDataService = engine->service("//blp/refdata");
     bbg::Request request = refDataService.createRequest("IntradayTickRequest");
 
     // only one security/eventType per request
@@ -170,33 +191,34 @@ Rcpp::DataFrame getTicks_Impl(SEXP con,
     request.set(bbg::Name{"endDateTime"}, endDateTime.c_str());
 
     if (verbose) Rcpp::Rcout <<"Sending Request: " << request << std::endl;
-    session->sendRequest(request);
+    std::vector<bbg::Message> responses = engine.request(request);
 
-    Ticks ticks;
-
-    // eventLoop
-    bool done = false;
-    while (!done) {
-        bbg::Event event = session->nextEvent();
-        if (event.eventType() == bbg::Event::PARTIAL_RESPONSE) {
-            if (verbose) Rcpp::Rcout << "Processing Partial Response" << std::endl;
-            processResponseEvent(event, ticks, verbose);
-        } else if (event.eventType() == bbg::Event::RESPONSE) {
-            if (verbose) Rcpp::Rcout << "Processing Response" << std::endl;
-            processResponseEvent(event, ticks, verbose);
-            done = true;
-        } else {
-            bbg::MessageIterator msgIter(event);
-            while (msgIter.next()) {
-                bbg::Message msg = msgIter.message();
-                if (event.eventType() == bbg::Event::SESSION_STATUS) {
-                    if (msg.messageType() == SESSION_TERMINATED) {
-                        done = true;
-                    }
-                }
-            }
+    for (bbg::Message& msg : responses) {
+        if (msg.hasElement(RESPONSE_ERROR)) {
+            Rcpp::Rcerr << "REQUEST FAILED: " << msg.getElement(RESPONSE_ERROR) << std::endl;
+            continue;
         }
+        processMessage(msg, acc, verbose);
     }
+}
+#else
+#include <Rcpp/Lightest>
+#endif
+
+// [[Rcpp::export]]
+Rcpp::DataFrame getTicks_Impl(SEXP con,
+                              std::string security,
+                              std::vector<std::string> eventType,
+                              std::string startDateTime,
+                              std::string endDateTime,
+                              bool setCondCodes=true,
+                              bool verbose=false) {
+#if defined(HaveBlp)
+    // via Rcpp Attributes we get a try/catch block with error propagation to R "for free"
+    ConnectionEngine engine(con, security);
+
+    Ticks ticks;
+    runTickRequest(engine, security, eventType, startDateTime, endDateTime, setCondCodes, verbose, ticks);
 
     return Rcpp::DataFrame::create(Rcpp::Named("times") = createPOSIXtVector(ticks.time),
                                    Rcpp::Named("type") = ticks.type,
@@ -208,3 +230,29 @@ Rcpp::DataFrame getTicks_Impl(SEXP con,
 #endif
 
 }
+
+// [[Rcpp::export]]
+Rcpp::DataFrame getQuotedTrades_Impl(SEXP con,
+                                     std::string security,
+                                     std::vector<std::string> eventType,
+                                     std::string startDateTime,
+                                     std::string endDateTime,
+                                     bool verbose=false) {
+#if defined(HaveBlp)
+    ConnectionEngine engine(con, security);
+
+    QuotedTrades trades;
+    runTickRequest(engine, security, eventType, startDateTime, endDateTime, true, verbose, trades);
+
+    return Rcpp::DataFrame::create(Rcpp::Named("times") = createPOSIXtVector(trades.time),
+                                   Rcpp::Named("value") = trades.value,
+                                   Rcpp::Named("size")  = trades.size,
+                                   Rcpp::Named("condcode") = trades.conditionCode,
+                                   Rcpp::Named("bid") = trades.bid,
+                                   Rcpp::Named("bidSize") = trades.bidSize,
+                                   Rcpp::Named("ask") = trades.ask,
+                                   Rcpp::Named("askSize") = trades.askSize);
+#else // ie no Blp
+    return Rcpp::DataFrame();
+#endif
+}
@@ -0,0 +1,314 @@
+// -*- mode: C++; c-indent-level: 4; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+//
+//  journal.cpp -- append-only memory-mapped journal of subscription updates
+//
+//  Copyright (C) 2026  Whit Armstrong and Dirk Eddelbuettel
+//
+//  This file is part of Rblpapi
+//
+//  Rblpapi is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  Rblpapi is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Rblpapi.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <journal.h>
+
+namespace bip = boost::interprocess;
+namespace fs = std::filesystem;
+
+const char JOURNAL_MAGIC[8] = { 'R', 'B', 'L', 'P', 'J', 'R', 'N', '1' };
+
+std::string journalSegmentPath(const std::string& dir, uint32_t segment) {
+    char name[32];
+    snprintf(name, sizeof(name), "segment-%06u.rbj", segment);
+    return (fs::path(dir) / name).string();
+}
+
+namespace {
+    template <typename T>
+    inline void put(char*& p, const T& v) {
+        std::memcpy(p, &v, sizeof(T));
+        p += sizeof(T);
+    }
+
+    template <typename T>
+    inline T get(const char*& p) {
+        T v;
+        std::memcpy(&v, p, sizeof(T));
+        p += sizeof(T);
+        return v;
+    }
+
+    size_t recordSize(const Update& u, uint16_t& nvalues) {
+        size_t n = sizeof(uint32_t) + sizeof(double) + sizeof(int32_t) + sizeof(uint16_t);
+        nvalues = 0;
+        for (const auto& v : u.values) {
+            if (v.isNull()) continue;
+            ++nvalues;
+            n += sizeof(uint16_t) + sizeof(uint8_t);
+            n += v.kind == FieldValue::String ? sizeof(uint32_t) + v.str.size() : sizeof(double);
+        }
+        return n;
+    }
+}
+
+JournalWriter::JournalWriter(const std::string& dir, size_t segmentSize, double rotateSeconds,
+                             double indexInterval)
+    : dir(dir), segmentSize(segmentSize), rotateSeconds(rotateSeconds), indexInterval(indexInterval) {
+    if (segmentSize < 4096) {
+        throw std::runtime_error("Journal segment size must be at least 4096 bytes.");
+    }
+    fs::create_directories(dir);
+    if (fs::exists(fs::path(dir) / "meta.txt")) {
+        throw std::runtime_error("Directory '" + dir + "' already holds a journal.");
+    }
+    index = std::fopen((fs::path(dir) / "index.rbi").string().c_str(), "wb");
+    if (index == nullptr) {
+        throw std::runtime_error("Cannot create journal index in '" + dir + "'.");
+    }
+    writeMeta();
+}
+
+JournalWriter::~JournalWriter() {
+    try {
+        close();
+    } catch (...) {
+        // nothing sensible left to do
+    }
+}
+
+void JournalWriter::setTopics(const std::vector<std::string>& t) {
+    if (t == topics) return;
+    topics = t;
+    writeMeta();
+}
+
+void JournalWriter::setFields(const std::vector<std::string>& f) {
+    if (f == fields) return;
+    fields = f;
+    writeMeta();
+}
+
+void JournalWriter::writeMeta() {
+    // written to the side and renamed so that readers never see a partial file
+    const fs::path meta = fs::path(dir) / "meta.txt";
+    const fs::path tmp = fs::path(dir) / "meta.txt.tmp";
+    {
+        std::ofstream out(tmp.string(), std::ios::trunc);
+        out << "# Rblpapi journal 1\n";
+        for (size_t i = 0; i < topics.size(); ++i) out << "topic\t" << i << "\t" << topics[i] << "\n";
+        for (size_t i = 0; i < fields.size(); ++i) out << "field\t" << i << "\t" << fields[i] << "\n";
+        if (!out) throw std::runtime_error("Cannot write journal meta data in '" + dir + "'.");
+    }
+    fs::rename(tmp, meta);
+}
+
+void JournalWriter::openSegment(double now) {
+    ++segment;
+    const std::string path = journalSegmentPath(dir, segment);
+    {
+        std::filebuf fb;
+        if (!fb.open(path, std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary)) {
+            throw std::runtime_error("Cannot create journal segment '" + path + "'.");
+        }
+        fb.pubseekoff(segmentSize - 1, std::ios::beg);
+        fb.sputc(0);
+    }
+    bip::file_mapping mapping(path.c_str(), bip::read_write);
+    region.reset(new bip::mapped_region(mapping, bip::read_write, 0, segmentSize));
+    base = static_cast<char*>(region->get_address());
+
+    JournalHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, JOURNAL_MAGIC, sizeof(h.magic));
+    h.version = 1;
+    h.headerSize = sizeof(JournalHeader);
+    h.used = sizeof(JournalHeader);
+    h.created = now;
+    h.segment = segment;
+    std::memcpy(base, &h, sizeof(h));
+    pos = sizeof(JournalHeader);
+    segmentStart = now;
+    lastIndexed = 0.0;                  // index the first record of every segment
+}
+
+void JournalWriter::closeSegment() {
+    if (!region) return;
+    region->flush();
+    region.reset();
+    std::fflush(index);
+    base = nullptr;
+    // give back the unused, preallocated tail
+    fs::resize_file(journalSegmentPath(dir, segment), pos);
+}
+
+void JournalWriter::writeIndex(double time) {
+    JournalIndexEntry e{time, segment, 0, pos};
+    std::fwrite(&e, sizeof(e), 1, index);
+    lastIndexed = time;
+}
+
+void JournalWriter::append(const Update& u) {
+    if (index == nullptr) {
+        throw std::runtime_error("Journal has been closed.");
+    }
+    uint16_t nvalues;
+    const size_t size = recordSize(u, nvalues);
+    if (size > segmentSize - sizeof(JournalHeader)) {
+        throw std::runtime_error("Update does not fit into a journal segment.");
+    }
+    if (!region ||
+        pos + size > segmentSize ||
+        (rotateSeconds > 0.0 && u.received - segmentStart >= rotateSeconds)) {
+        closeSegment();
+        openSegment(u.received);
+    }
+    if (u.received - lastIndexed >= indexInterval) {
+        writeIndex(u.received);
+    }
+
+    char* p = base + pos;
+    put(p, static_cast<uint32_t>(size));
+    put(p, u.received);
+    put(p, static_cast<int32_t>(u.topic));
+    put(p, nvalues);
+    for (size_t j = 0; j < u.values.size(); ++j) {
+        const FieldValue& v = u.values[j];
+        if (v.isNull()) continue;
+        put(p, static_cast<uint16_t>(j));
+        put(p, static_cast<uint8_t>(v.kind));
+        if (v.kind == FieldValue::String) {
+            put(p, static_cast<uint32_t>(v.str.size()));
+            std::memcpy(p, v.str.data(), v.str.size());
+            p += v.str.size();
+        } else {
+            put(p, v.num);
+        }
+    }
+    pos += size;
+    ++total;
+
+    // publish the record only once it is complete
+    JournalHeader* h = reinterpret_cast<JournalHeader*>(base);
+    h->records += 1;
+    h->used = pos;
+}
+
+void JournalWriter::close() {
+    closeSegment();
+    if (index != nullptr) {
+        std::fclose(index);
+        index = nullptr;
+    }
+}
+
+JournalReader::JournalReader(const std::string& dir) : dir(dir) {
+    readMeta();
+    if (!openSegment(1, sizeof(JournalHeader))) {
+        base = nullptr;                 // a journal without any records
+    }
+}
+
+void JournalReader::readMeta() {
+    std::ifstream in((fs::path(dir) / "meta.txt").string());
+    if (!in) {
+        throw std::runtime_error("No journal found in '" + dir + "'.");
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        size_t t1 = line.find('\t'), t2 = line.find('\t', t1 + 1);
+        if (t1 == std::string::npos || t2 == std::string::npos) continue;
+        const std::string kind = line.substr(0, t1);
+        const size_t id = std::stoul(line.substr(t1 + 1, t2 - t1 - 1));
+        std::vector<std::string>& names = kind == "topic" ? topics_ : fields_;
+        if (names.size() <= id) names.resize(id + 1);
+        names[id] = line.substr(t2 + 1);
+    }
+}
+
+bool JournalReader::openSegment(uint32_t s, uint64_t offset) {
+    region.reset();
+    base = nullptr;
+    const std::string path = journalSegmentPath(dir, s);
+    if (!fs::exists(path)) return false;
+    const size_t fileSize = fs::file_size(path);
+    if (fileSize < sizeof(JournalHeader)) {
+        throw std::runtime_error("Journal segment '" + path + "' is truncated.");
+    }
+    bip::file_mapping mapping(path.c_str(), bip::read_only);
+    region.reset(new bip::mapped_region(mapping, bip::read_only));
+    base = static_cast<const char*>(region->get_address());
+
+    JournalHeader h;
+    std::memcpy(&h, base, sizeof(h));
+    if (std::memcmp(h.magic, JOURNAL_MAGIC, sizeof(h.magic)) != 0 || h.version != 1) {
+        throw std::runtime_error("'" + path + "' is not a journal segment.");
+    }
+    used = std::min<size_t>(h.used, fileSize);
+    pos = std::max<size_t>(offset, h.headerSize);
+    segment = s;
+    return true;
+}
+
+void JournalReader::seek(double time) {
+    std::ifstream in((fs::path(dir) / "index.rbi").string(), std::ios::binary);
+    JournalIndexEntry e, best{0.0, 1, 0, sizeof(JournalHeader)};
+    while (in.read(reinterpret_cast<char*>(&e), sizeof(e))) {
+        if (e.time > time) break;       // entries are in time order
+        best = e;
+    }
+    if (!openSegment(best.segment, best.offset)) {
+        base = nullptr;
+    }
+    skipBefore = time;
+}
+
+bool JournalReader::next(Update& u) {
+    while (base != nullptr) {
+        if (pos + sizeof(uint32_t) > used) {
+            if (!openSegment(segment + 1, sizeof(JournalHeader))) return false;
+            continue;
+        }
+        const char* p = base + pos;
+        const uint32_t size = get<uint32_t>(p);
+        if (size == 0 || pos + size > used) {
+            throw std::runtime_error("Corrupt record in journal segment " + std::to_string(segment) + ".");
+        }
+        pos += size;
+        u.received = get<double>(p);
+        if (u.received < skipBefore) continue;
+        u.topic = get<int32_t>(p);
+        const uint16_t nvalues = get<uint16_t>(p);
+        u.values.assign(fields_.size(), FieldValue());
+        for (uint16_t i = 0; i < nvalues; ++i) {
+            const uint16_t field = get<uint16_t>(p);
+            if (field >= u.values.size()) u.values.resize(field + 1);
+            FieldValue& v = u.values[field];
+            v.kind = static_cast<FieldValue::Kind>(get<uint8_t>(p));
+            if (v.kind == FieldValue::String) {
+                const uint32_t len = get<uint32_t>(p);
+                v.str.assign(p, len);
+                p += len;
+            } else {
+                v.num = get<double>(p);
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
@@ -0,0 +1,144 @@
+// -*- mode: C++; c-indent-level: 4; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+//
+//  journal.h -- append-only memory-mapped journal of subscription updates
+//
+//  Copyright (C) 2026  Whit Armstrong and Dirk Eddelbuettel
+//
+//  This file is part of Rblpapi
+//
+//  Rblpapi is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  Rblpapi is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Rblpapi.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <subscription.h>
+
+// A journal is a directory holding
+//
+//   meta.txt             topic and field ids with their names, one per line
+//   segment-NNNNNN.rbj   memory-mapped segments of update records
+//   index.rbi            (time, segment, offset) entries to seek by time
+//
+// Each segment starts with a JournalHeader whose 'used' member is only
+// advanced once a record is complete, so a segment left behind by a crash
+// is readable up to its last complete record. A record is
+//
+//   uint32 size | double received | int32 topic | uint16 nvalues
+//
+// followed by nvalues non-null values, each
+//
+//   uint16 field | uint8 kind | double value   or   uint32 length | bytes
+//
+// for numeric kinds and strings respectively, all in host byte order.
+
+struct JournalHeader {
+    char magic[8];                      // "RBLPJRN1"
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t used;                      // bytes in use, including this header
+    uint64_t records;
+    double created;
+    uint32_t segment;
+    uint32_t reserved[5];
+};
+
+struct JournalIndexEntry {
+    double time;
+    uint32_t segment;
+    uint32_t reserved;
+    uint64_t offset;
+};
+
+extern const char JOURNAL_MAGIC[8];
+
+std::string journalSegmentPath(const std::string& dir, uint32_t segment);
+
+// Writes updates to a new journal; not thread-safe, meant to be driven by the
+// one thread that decodes the updates. Errors are thrown as std::runtime_error.
+class JournalWriter {
+public:
+    // segmentSize in bytes; rotateSeconds of zero rotates by size only
+    JournalWriter(const std::string& dir, size_t segmentSize, double rotateSeconds,
+                  double indexInterval = 1.0);
+    ~JournalWriter();
+
+    void setTopics(const std::vector<std::string>& topics);
+    void setFields(const std::vector<std::string>& fields);
+    size_t numTopics() const { return topics.size(); }
+    size_t numFields() const { return fields.size(); }
+
+    void append(const Update& u);
+    void close();
+
+    uint64_t records() const { return total; }
+    uint32_t segments() const { return segment; }
+
+private:
+    void openSegment(double now);
+    void closeSegment();
+    void writeMeta();
+    void writeIndex(double time);
+
+    std::string dir;
+    size_t segmentSize;
+    double rotateSeconds;
+    double indexInterval;
+
+    std::vector<std::string> topics;
+    std::vector<std::string> fields;
+
+    std::unique_ptr<boost::interprocess::mapped_region> region;
+    char* base = nullptr;
+    size_t pos = 0;
+    uint32_t segment = 0;               // current segment number, counting from one
+    double segmentStart = 0.0;
+    double lastIndexed = 0.0;
+    uint64_t total = 0;
+    std::FILE* index = nullptr;
+};
+
+// Reads a journal back in the order it was written, reproducing topic ids,
+// field ids and value types. Errors are thrown as std::runtime_error.
+class JournalReader {
+public:
+    explicit JournalReader(const std::string& dir);
+
+    const std::vector<std::string>& topics() const { return topics_; }
+    const std::vector<std::string>& fields() const { return fields_; }
+
+    // position on the first record received at or after 'time'
+    void seek(double time);
+    bool next(Update& u);
+
+private:
+    void readMeta();
+    bool openSegment(uint32_t s, uint64_t offset);
+
+    std::string dir;
+    std::vector<std::string> topics_;
+    std::vector<std::string> fields_;
+
+    std::unique_ptr<boost::interprocess::mapped_region> region;
+    const char* base = nullptr;
+    size_t pos = 0;
+    size_t used = 0;
+    uint32_t segment = 0;
+    double skipBefore = 0.0;
+};
@@ -30,6 +30,7 @@
 #include <vector>
 #include <string>
 #include <blpapi_utils.h>
+#include <requestengine.h>
 
 namespace bbg = BloombergLP::blpapi;	// shortcut to not globally import both namespace
 
@@ -37,7 +38,6 @@ namespace {
     const bbg::Name SECURITY("security");
     const bbg::Name DESCRIPTION("description");
     const bbg::Name RESPONSE_ERROR("responseError");
-    const bbg::Name SESSION_TERMINATED("SessionTerminated");
 }
 
 struct InstrumentListResults {
@@ -71,17 +71,6 @@ void processMessage(bbg::Message &msg, InstrumentListResults &matches, const boo
     }
 }
 
-void processResponseEvent(bbg::Event &event, InstrumentListResults &matches, const bool verbose) {
-    bbg::MessageIterator msgIter(event);
-    while (msgIter.next()) {
-        bbg::Message msg = msgIter.message();
-        if (msg.hasElement(RESPONSE_ERROR)) {
-            Rcpp::Rcerr << "REQUEST FAILED: " << msg.getElement(RESPONSE_ERROR) << std::endl;
-            continue;
-        }
-        processMessage(msg, matches, verbose);
-    }
-}
 #else
 #include <Rcpp/Lightest>
 #endif
@@ -95,14 +84,9 @@ Rcpp::DataFrame lookup_Impl(SEXP con,
                             bool verbose=false) {
 #if defined(HaveBlp)
     // via Rcpp Attributes we get a try/catch block with error propagation to R "for free"
-    bbg::Session* session =
-        reinterpret_cast<bbg::Session*>(checkExternalPointer(con,"blpapi::Session*"));
+    ConnectionEngine engine(con);
 
-    if (!session->openService("//blp/instruments")) {
-        Rcpp::stop("Failed to open //blp/instruments");
-    }
-
-    bbg::Service secfService = session->getService("//blp/instruments");
+    bbg::Service secfService = engine->service("//blp/instruments");
     bbg::Request request = secfService.createRequest("instrumentListRequest");
 
     request.set(bbg::Name{"query"}, query.c_str());
@@ -111,32 +95,15 @@ Rcpp::DataFrame lookup_Impl(SEXP con,
     request.set(bbg::Name{"maxResults"}, maxResults);
 
     if (verbose) Rcpp::Rcout <<"Sending Request: " << request << std::endl;
-    session->sendRequest(request);
+    std::vector<bbg::Message> responses = engine.request(request);
 
     InstrumentListResults matches;
-
-    // eventLoop
-    bool done = false;
-    while (!done) {
-        bbg::Event event = session->nextEvent();
-        if (event.eventType() == bbg::Event::PARTIAL_RESPONSE) {
-            if (verbose) Rcpp::Rcout << "Processing Partial Response" << std::endl;
-            processResponseEvent(event, matches, verbose);
-        } else if (event.eventType() == bbg::Event::RESPONSE) {
-            if (verbose) Rcpp::Rcout << "Processing Response" << std::endl;
-            processResponseEvent(event, matches, verbose);
-            done = true;
-        } else {
-            bbg::MessageIterator msgIter(event);
-            while (msgIter.next()) {
-                bbg::Message msg = msgIter.message();
-                if (event.eventType() == bbg::Event::SESSION_STATUS) {
-                    if (msg.messageType() == SESSION_TERMINATED) {
-                        done = true;
-                    }
-                }
-            }
+    for (bbg::Message& msg : responses) {
+        if (msg.hasElement(RESPONSE_ERROR)) {
+            Rcpp::Rcerr << "REQUEST FAILED: " << msg.getElement(RESPONSE_ERROR) << std::endl;
+            continue;
         }
+        processMessage(msg, matches, verbose);
     }
 
     return Rcpp::DataFrame::create(Rcpp::Named("security") = matches.security,
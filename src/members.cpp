@@ -0,0 +1,331 @@
+// -*- mode: C++; c-indent-level: 4; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+//
+//  members.cpp -- members of an index, portfolio or screen with their reference data
+//
+//  Copyright (C) 2026  Whit Armstrong and Dirk Eddelbuettel
+//
+//  This file is part of Rblpapi
+//
+//  Rblpapi is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  Rblpapi is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Rblpapi.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#if defined(HaveBlp)
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include <blpapi_utils.h>
+#include <refdata.h>
+
+namespace bbg = BloombergLP::blpapi;
+
+namespace {
+    const bbg::Name SECURITIES("securities");
+    const bbg::Name FIELDS("fields");
+    const bbg::Name OVERRIDES("overrides");
+    const bbg::Name FIELD_ID("fieldId");
+    const bbg::Name VALUE("value");
+    const bbg::Name RESPONSE_ERROR("responseError");
+    const bbg::Name MESSAGE("message");
+    const bbg::Name DATA("data");
+    const bbg::Name SECURITY_DATA("securityData");
+    const bbg::Name SEQUENCE_NUMBER("sequenceNumber");
+    const bbg::Name SECURITY("security");
+    const bbg::Name FIELD_DATA("fieldData");
+
+    const char* const YELLOW_KEYS[] = { "Equity", "Comdty", "Index", "Curncy", "Corp", "Govt",
+                                        "Mtge", "Muni", "Pfd", "M-Mkt" };
+
+    bool sameKey(const std::string& a, const char* b) {
+        if (a.size() != std::strlen(b)) return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // "AAPL UW" or " aapl  uw equity " become "AAPL UW Equity": blanks are
+    // trimmed and collapsed, and the yellow key appended unless one is there
+    std::string normalizeTicker(const std::string& ticker, const std::string& yellowKey) {
+        std::vector<std::string> words;
+        std::istringstream in(ticker);
+        for (std::string w; in >> w; ) words.push_back(w);
+        if (words.empty()) return std::string();
+        bool keyed = false;
+        for (const char* key : YELLOW_KEYS) {
+            if (sameKey(words.back(), key)) {
+                words.back() = key;
+                keyed = true;
+                break;
+            }
+        }
+        if (!keyed && !yellowKey.empty()) words.push_back(yellowKey);
+        std::string res = words[0];
+        for (size_t i = 1; i < words.size(); ++i) res += ' ' + words[i];
+        return res;
+    }
+
+    void checkResponse(const bbg::Element& response, const char* expected) {
+        if (std::strcmp(response.name().string(), expected)) {
+            throw std::runtime_error(std::string("Not a valid ") + expected + ".");
+        }
+        if (response.hasElement(RESPONSE_ERROR)) {
+            bbg::Element errorElement = response.getElement(RESPONSE_ERROR);
+            std::string errMsg("");
+            if (errorElement.hasElement(MESSAGE)) {
+                errMsg = errorElement.getElementAsString(MESSAGE);
+            }
+            throw std::runtime_error("a responseError was received with message: (" + errMsg + ")");
+        }
+    }
+
+    // The members of indices, portfolios or a screen, found through a bulk
+    // field, a portfolio field or a BeqsRequest, along with reference data
+    // for them. The member requests are sent from decode() as each partial
+    // response of the source request arrives, so they are in flight while the
+    // rest of the membership is still coming in; members repeated across
+    // partial responses or sources are asked for once.
+    class MemberState : public TypedRequestState {
+    public:
+        enum Kind { Bulk, Portfolio, Screen };
+
+        MemberState(Kind kind, const std::string& field, const std::string& screen, const std::string& column,
+                     const std::string& yellowKey, size_t batchSize, std::shared_ptr<const RefDataLayout> layout,
+                     const bbg::Service& refdata, const bbg::Service& fieldService, bbg::Request* source,
+                     const bbg::Identity* identity, bool verbose)
+            : TypedRequestState(layout->fields, fieldService, source), kind(kind), field(field),
+              screen(screen), column(column), yellowKey(yellowKey), batchSize(batchSize), layout(layout),
+              refdata(refdata), identity(identity), verbose(verbose) {}
+
+        SEXP materialize() override {
+            if (verbose) Rcpp::Rcout << log.str();
+            std::vector<std::string> names{"source", "member"};
+            std::vector<RblpapiT> types{RblpapiT::String, RblpapiT::String};
+            names.insert(names.end(), layout->fields.begin(), layout->fields.end());
+            types.insert(types.end(), rtypes.begin(), rtypes.end());
+            Rcpp::List res(allocateDataFrame(rows.size(), names, types));
+            SEXP sources = res[0], members = res[1];
+            const size_t ncol = layout->fields.size();
+            for (size_t i = 0; i < rows.size(); ++i) {
+                SET_STRING_ELT(sources, i, Rf_mkCharCE(rows[i].first.c_str(), CE_UTF8));
+                SET_STRING_ELT(members, i, Rf_mkCharCE(tickers[rows[i].second].c_str(), CE_UTF8));
+            }
+            for (size_t j = 0; j < ncol; ++j) {
+                SEXP col = res[j + 2];
+                for (size_t i = 0; i < rows.size(); ++i) {
+                    setDfCell(col, i, cells[rows[i].second * ncol + j]);
+                }
+            }
+            res.attr("requests") = static_cast<int>(batches.size());
+            return res;
+        }
+
+    protected:
+        void typesResolved(const std::vector<RblpapiT>& types) override { rtypes = types; }
+
+        void decodeData(const bbg::Message& msg) override {
+            if (verbose) msg.asElement().print(log);
+            auto batch = batches.find(msg.correlationId().asInteger());
+            if (batch != batches.end()) {
+                decodeMembers(msg.asElement(), batch->second);
+                return;
+            }
+            if (kind == Screen) {
+                checkResponse(msg.asElement(), "BeqsResponse");
+                bbg::Element securityData = msg.getElement(DATA).getElement(SECURITY_DATA);
+                for (size_t i = 0; i < securityData.numValues(); ++i) {
+                    bbg::Element s = securityData.getValueAsElement(i);
+                    const std::string ticker = column.empty() ? s.getElementAsString(SECURITY)
+                        : fieldString(s.getElement(FIELD_DATA), column);
+                    addMember(screen, ticker);
+                }
+            } else {
+                checkResponse(msg.asElement(), kind == Bulk ? "ReferenceDataResponse" : "PortfolioDataResponse");
+                const bbg::Name bulkField(field.c_str());
+                bbg::Element securityData = msg.getElement(SECURITY_DATA);
+                for (size_t i = 0; i < securityData.numValues(); ++i) {
+                    bbg::Element s = securityData.getValueAsElement(i);
+                    const std::string source = s.getElementAsString(SECURITY);
+                    bbg::Element fieldData = s.getElement(FIELD_DATA);
+                    if (!fieldData.hasElement(bulkField)) continue;
+                    bbg::Element bulk = fieldData.getElement(bulkField);
+                    for (size_t k = 0; k < bulk.numValues(); ++k) {
+                        bbg::Element row = bulk.getValueAsElement(k);
+                        if (row.numElements() == 0) continue;
+                        addMember(source, column.empty() ? std::string(row.getElement(0).getValueAsString())
+                                                         : fieldString(row, column));
+                    }
+                }
+            }
+            sendMembers();
+        }
+
+    private:
+        static std::string fieldString(const bbg::Element& e, const std::string& name) {
+            bbg::Name n(name.c_str());
+            if (!e.hasElement(n)) return std::string();
+            bbg::Element v = e.getElement(n);
+            return v.isNull() ? std::string() : std::string(v.getValueAsString());
+        }
+
+        void addMember(const std::string& source, const std::string& ticker) {
+            const std::string member = normalizeTicker(ticker, yellowKey);
+            if (member.empty()) return;
+            auto it = memberIndex.find(member);
+            if (it == memberIndex.end()) {
+                it = memberIndex.emplace(member, tickers.size()).first;
+                tickers.push_back(member);
+                unsent.push_back(it->second);
+                cells.resize(tickers.size() * layout->fields.size());
+            }
+            if (seen.insert(source + '\x1f' + member).second) {
+                rows.emplace_back(source, it->second);
+            }
+        }
+
+        // the members found so far, in requests of at most batchSize
+        void sendMembers() {
+            for (size_t from = 0; from < unsent.size(); from += batchSize) {
+                std::vector<size_t> batch(unsent.begin() + from,
+                                          unsent.begin() + std::min(unsent.size(), from + batchSize));
+                std::vector<std::string> securities;
+                for (size_t m : batch) securities.push_back(tickers[m]);
+                bbg::Request request = refdata.createRequest("ReferenceDataRequest");
+                layout->fill(request, securities);
+                // decode() is serialised, so the response is not decoded
+                // before its batch is recorded
+                batches.emplace(send(request, identity), std::move(batch));
+            }
+            unsent.clear();
+        }
+
+        void decodeMembers(const bbg::Element& response, const std::vector<size_t>& batch) {
+            checkResponse(response, "ReferenceDataResponse");
+            const size_t ncol = layout->fields.size();
+            bbg::Element securityData = response.getElement(SECURITY_DATA);
+            for (size_t i = 0; i < securityData.numValues(); ++i) {
+                bbg::Element s = securityData.getValueAsElement(i);
+                const size_t seq = s.getElement(SEQUENCE_NUMBER).getValueAsInt32();
+                if (seq >= batch.size()) {
+                    throw std::runtime_error("mismatched Security sequence, please report a bug.");
+                }
+                const size_t member = batch[seq];
+                bbg::Element fieldData = s.getElement(FIELD_DATA);
+                for (size_t j = 0; j < fieldData.numElements(); ++j) {
+                    bbg::Element e = fieldData.getElement(j);
+                    auto col = layout->columns.find(e.name().string());
+                    if (col == layout->columns.end()) {
+                        throw std::runtime_error(std::string("column is not expected: ") + e.name().string());
+                    }
+                    cells[member * ncol + col->second] = elementToCell(e, rtypes[col->second]);
+                }
+            }
+        }
+
+        Kind kind;
+        std::string field, screen, column, yellowKey;
+        size_t batchSize;
+        std::shared_ptr<const RefDataLayout> layout;
+        bbg::Service refdata;
+        const bbg::Identity* identity;
+        bool verbose;
+        std::vector<RblpapiT> rtypes;
+
+        std::vector<std::string> tickers;                   // members, normalised
+        std::unordered_map<std::string, size_t> memberIndex;
+        std::vector<size_t> unsent;                         // members without a request yet
+        std::unordered_map<long long, std::vector<size_t>> batches;   // request to its members
+        std::vector<std::pair<std::string, size_t>> rows;   // source and member
+        std::unordered_set<std::string> seen;
+        std::vector<FieldValue> cells;                      // row-major, by member
+        std::ostringstream log;
+    };
+}
+#else
+#include <Rcpp/Lightest>
+#endif
+
+// source is a list with the elements of the request for the members:
+// securities, field, options and overrides for a bulk or portfolio field,
+// screenName, screenType, group, pitdate and languageId for a screen
+//
+// [[Rcpp::export]]
+Rcpp::List bdpMembers_Impl(SEXP con_, std::string kind, Rcpp::List source, std::vector<std::string> fields,
+                           SEXP options_, SEXP overrides_, std::string column, std::string yellowKey,
+                           int batchSize, bool verbose, SEXP identity_) {
+#if defined(HaveBlp)
+    if (batchSize < 1) {
+        Rcpp::stop("Batch size must be positive.");
+    }
+    MemberState::Kind k;
+    if (kind == "bds") k = MemberState::Bulk;
+    else if (kind == "portfolio") k = MemberState::Portfolio;
+    else if (kind == "beqs") k = MemberState::Screen;
+    else Rcpp::stop("Unknown source of members: " + kind);
+
+    std::vector<std::string> securities;
+    std::string field, screen;
+    if (k != MemberState::Screen) {
+        securities = Rcpp::as<std::vector<std::string>>(source["securities"]);
+        field = Rcpp::as<std::string>(source["field"]);
+    } else {
+        screen = Rcpp::as<std::string>(source["screenName"]);
+    }
+    ConnectionEngine engine(con_, securities);
+    const bbg::Identity* identity = engine.identity(identity_);
+
+    bbg::Service refdata = engine->service("//blp/refdata");
+    bbg::Request* request = new bbg::Request(refdata.createRequest(k == MemberState::Bulk ? "ReferenceDataRequest"
+                                                                   : k == MemberState::Portfolio ? "PortfolioDataRequest"
+                                                                   : "BeqsRequest"));
+    if (k != MemberState::Screen) {
+        for (const auto& s : securities) request->getElement(SECURITIES).appendValue(s.c_str());
+        request->getElement(FIELDS).appendValue(field.c_str());
+        appendOptionsToRequest(*request, source["options"]);
+        appendOverridesToRequest(*request, source["overrides"]);
+    } else {
+        request->set(bbg::Name{"screenName"}, screen.c_str());
+        request->set(bbg::Name{"screenType"}, Rcpp::as<std::string>(source["screenType"]).c_str());
+        const std::string group = Rcpp::as<std::string>(source["group"]);
+        if (group != "") request->set(bbg::Name{"Group"}, group.c_str());
+        const std::string languageId = Rcpp::as<std::string>(source["languageId"]);
+        if (languageId != "") request->set(bbg::Name{"languageId"}, languageId.c_str());
+        const std::string pitdate = Rcpp::as<std::string>(source["pitdate"]);
+        if (pitdate != "") {
+            bbg::Element o = request->getElement(OVERRIDES).appendElement();
+            o.setElement(FIELD_ID, "PiTDate");
+            o.setElement(VALUE, pitdate.c_str());
+        }
+    }
+
+    auto layout = std::make_shared<const RefDataLayout>(fields, options_, overrides_);
+    auto state = std::make_shared<MemberState>(k, field, screen, column, yellowKey, batchSize, layout, refdata,
+                                               engine->service("//blp/apiflds"), request, identity, verbose);
+    state->start(*engine, identity);
+    engine->await(state);
+    return state->materialize();
+#else // ie no Blp
+    return Rcpp::List();
+#endif
+}
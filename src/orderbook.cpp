@@ -0,0 +1,261 @@
+// -*- mode: C++; c-indent-level: 4; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+//
+//  orderbook.cpp -- price-level order books built from market depth updates
+//
+//  Copyright (C) 2026  Whit Armstrong and Dirk Eddelbuettel
+//
+//  This file is part of Rblpapi
+//
+//  Rblpapi is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  Rblpapi is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Rblpapi.  If not, see <http://www.gnu.org/licenses/>.
+
+
+// The book itself needs no blpapi, so that it is also built, and can be
+// tested by replaying depth commands, without blp; only decoding the
+// messages of //blp/mktdepthdata is behind HaveBlp.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <orderbook.h>
+
+namespace {
+    const double NaN = std::numeric_limits<double>::quiet_NaN();
+}
+
+OrderBook::Command OrderBook::command(const std::string& cmd) {
+    if (cmd == "ADD") return Add;
+    if (cmd == "MOD") return Modify;
+    if (cmd == "DEL") return Delete;
+    if (cmd == "DELALL") return DeleteAll;
+    if (cmd == "DELBETTER") return DeleteBetter;
+    if (cmd == "DELSIDE") return DeleteSide;
+    if (cmd == "EXEC") return Execute;
+    if (cmd == "REPLACE" || cmd == "REPLACE_BY_BROKER" || cmd == "REPLACE_CLEAR") return Replace;
+    if (cmd == "CLEARALL") return ClearAll;
+    return Ignore;
+}
+
+void OrderBook::apply(Side s, Command cmd, size_t position, const BookLevel& level) {
+    std::vector<BookLevel>& v = sides[s];
+    const size_t i = position > 0 ? position - 1 : 0;
+    switch (cmd) {
+    case Add:
+        v.insert(v.begin() + std::min(i, v.size()), level);
+        break;
+    case Execute:
+        if (!(level.size > 0)) {
+            if (i < v.size()) v.erase(v.begin() + i);
+            break;
+        }
+        [[fallthrough]];                // a partial execution leaves the remainder
+    case Modify:
+    case Replace:
+        if (i >= v.size()) v.resize(i + 1, BookLevel{NaN, 0.0, 0});
+        v[i] = level;
+        break;
+    case Delete:
+        if (i < v.size()) v.erase(v.begin() + i);
+        break;
+    case DeleteBetter:
+        v.erase(v.begin(), v.begin() + std::min(i + 1, v.size()));
+        break;
+    case DeleteAll:
+    case DeleteSide:
+        v.clear();
+        break;
+    case ClearAll:
+        clear();
+        break;
+    case Ignore:
+        break;
+    }
+}
+
+void OrderBook::clear() {
+    sides[Bid].clear();
+    sides[Ask].clear();
+}
+
+double OrderBook::mid() const {
+    if (sides[Bid].empty() || sides[Ask].empty()) return NaN;
+    return 0.5 * (sides[Bid][0].price + sides[Ask][0].price);
+}
+
+double OrderBook::microprice() const {
+    if (sides[Bid].empty() || sides[Ask].empty()) return NaN;
+    const BookLevel& b = sides[Bid][0];
+    const BookLevel& a = sides[Ask][0];
+    const double total = b.size + a.size;
+    if (!(total > 0)) return mid();
+    return (b.price * a.size + a.price * b.size) / total;
+}
+
+double OrderBook::imbalance(size_t levels) const {
+    double size[2] = { 0.0, 0.0 };
+    for (int s = Bid; s <= Ask; ++s) {
+        const size_t n = std::min(levels, sides[s].size());
+        for (size_t i = 0; i < n; ++i) size[s] += sides[s][i].size;
+    }
+    const double total = size[Bid] + size[Ask];
+    return total > 0 ? (size[Bid] - size[Ask]) / total : NaN;
+}
+
+std::vector<std::string> OrderBook::metricNames() {
+    return { "BID", "ASK", "BID_SIZE", "ASK_SIZE", "MID", "MICROPRICE", "IMBALANCE",
+             "BID_LEVELS", "ASK_LEVELS" };
+}
+
+void OrderBook::metrics(size_t levels, Update& u) const {
+    u.values.assign(9, FieldValue());
+    auto number = [&](size_t j, double x) {
+        if (std::isnan(x)) return;
+        u.values[j].kind = FieldValue::Double;
+        u.values[j].num = x;
+    };
+    for (int s = Bid; s <= Ask; ++s) {
+        if (sides[s].empty()) continue;
+        number(s, sides[s][0].price);
+        number(2 + s, sides[s][0].size);
+    }
+    number(4, mid());
+    number(5, microprice());
+    number(6, imbalance(levels));
+    for (int s = Bid; s <= Ask; ++s) {
+        u.values[7 + s].kind = FieldValue::Integer;
+        u.values[7 + s].num = static_cast<double>(sides[s].size());
+    }
+}
+
+// Applies a table of depth commands, one row per MarketDepthUpdates entry,
+// to an empty book: the book metrics after each row and the final book.
+//
+// [[Rcpp::export]]
+Rcpp::List replayDepth_Impl(std::vector<std::string> side, std::vector<std::string> command,
+                            std::vector<int> position, std::vector<double> price,
+                            std::vector<double> size, std::vector<int> orders, int levels, int n) {
+    const size_t m = command.size();
+    const std::vector<std::string> names = OrderBook::metricNames();
+    Rcpp::List metrics(names.size());
+    for (size_t j = 0; j < names.size(); ++j) {  // all double but the BID_LEVELS and ASK_LEVELS counts
+        if (j >= 7) metrics[j] = Rcpp::IntegerVector(m);
+        else metrics[j] = Rcpp::NumericVector(m);
+    }
+
+    OrderBook book;
+    Update u;
+    for (size_t i = 0; i < m; ++i) {
+        const OrderBook::Command cmd = OrderBook::command(command[i]);
+        if (cmd == OrderBook::ClearAll) {
+            book.clear();
+        } else if (side[i] == "BID" || side[i] == "ASK") {
+            const BookLevel level{price[i], size[i], orders[i] == NA_INTEGER ? 0 : orders[i]};
+            book.apply(side[i] == "BID" ? OrderBook::Bid : OrderBook::Ask, cmd,
+                       position[i] > 0 ? static_cast<size_t>(position[i]) : 0, level);
+        } else {
+            Rcpp::stop("Side of row " + std::to_string(i + 1) + " is '" + side[i] + "', not 'BID' or 'ASK'.");
+        }
+        book.metrics(static_cast<size_t>(levels), u);
+        for (size_t j = 0; j < names.size(); ++j) {
+            SEXP column = metrics[j];
+            const FieldValue& v = u.values[j];
+            if (v.kind == FieldValue::Integer) {
+                INTEGER(column)[i] = static_cast<int>(v.num);
+            } else if (j >= 7) {
+                INTEGER(column)[i] = NA_INTEGER;
+            } else {
+                REAL(column)[i] = v.kind == FieldValue::Double ? v.num : NA_REAL;
+            }
+        }
+    }
+    metrics.names() = Rcpp::wrap(names);
+    metrics.attr("row.names") = Rcpp::IntegerVector::create(NA_INTEGER, -static_cast<int>(m));
+    metrics.attr("class") = "data.frame";
+
+    std::vector<int> side_, position_, orders_;
+    std::vector<double> price_, size_;
+    for (int s = OrderBook::Bid; s <= OrderBook::Ask; ++s) {
+        const std::vector<BookLevel>& v = book.side(static_cast<OrderBook::Side>(s));
+        const size_t k = n > 0 ? std::min(static_cast<size_t>(n), v.size()) : v.size();
+        for (size_t i = 0; i < k; ++i) {
+            side_.push_back(s + 1);
+            position_.push_back(static_cast<int>(i + 1));
+            price_.push_back(v[i].price);
+            size_.push_back(v[i].size);
+            orders_.push_back(v[i].orders);
+        }
+    }
+    Rcpp::IntegerVector sides = Rcpp::wrap(side_);
+    sides.attr("levels") = Rcpp::CharacterVector::create("bid", "ask");
+    sides.attr("class") = "factor";
+    Rcpp::DataFrame entries = Rcpp::DataFrame::create(Rcpp::Named("side")     = sides,
+                                                      Rcpp::Named("position") = position_,
+                                                      Rcpp::Named("price")    = price_,
+                                                      Rcpp::Named("size")     = size_,
+                                                      Rcpp::Named("orders")   = orders_);
+    return Rcpp::List::create(Rcpp::Named("metrics") = metrics,
+                              Rcpp::Named("book")    = entries);
+}
+
+#if defined(HaveBlp)
+#include <blpapi_element.h>
+#include <blpapi_name.h>
+
+namespace bbg = BloombergLP::blpapi;
+
+namespace {
+    const bbg::Name MKTDEPTH_EVENT_SUBTYPE("MKTDEPTH_EVENT_SUBTYPE");
+    const bbg::Name MD_TABLE_CMD_RT("MD_TABLE_CMD_RT");
+    const bbg::Name POSITION[2] = { bbg::Name("BID_POS_RT"), bbg::Name("ASK_POS_RT") };
+    const bbg::Name PRICE[2] = { bbg::Name("BID_RT"), bbg::Name("ASK_RT") };
+    const bbg::Name SIZE[2] = { bbg::Name("BID_SIZE_RT"), bbg::Name("ASK_SIZE_RT") };
+    const bbg::Name ORDERS[2] = { bbg::Name("BID_NUM_ORDERS_RT"), bbg::Name("ASK_NUM_ORDERS_RT") };
+
+    double numberOf(const bbg::Element& e, const bbg::Name& name) {
+        if (!e.hasElement(name, true)) return NaN;
+        return e.getElementAsFloat64(name);
+    }
+}
+
+bool applyDepthMessage(const bbg::Message& msg, OrderBook& book) {
+    bbg::Element e = msg.asElement();
+    // the initial paint and retransmissions carry no command and set the entry
+    OrderBook::Command cmd = OrderBook::Replace;
+    if (e.hasElement(MD_TABLE_CMD_RT, true)) {
+        cmd = OrderBook::command(e.getElementAsString(MD_TABLE_CMD_RT));
+    }
+    if (cmd == OrderBook::ClearAll) {
+        book.clear();
+        return true;
+    }
+    // an explicit side restricts the entry to it, otherwise either side present is applied
+    std::string subtype;
+    if (e.hasElement(MKTDEPTH_EVENT_SUBTYPE, true)) subtype = e.getElementAsString(MKTDEPTH_EVENT_SUBTYPE);
+    const bool onlyBid = subtype.compare(0, 3, "BID") == 0;
+    const bool onlyAsk = subtype.compare(0, 3, "ASK") == 0;
+
+    bool applied = false;
+    for (int s = OrderBook::Bid; s <= OrderBook::Ask; ++s) {
+        if ((s == OrderBook::Bid && onlyAsk) || (s == OrderBook::Ask && onlyBid)) continue;
+        if (!e.hasElement(POSITION[s], true)) continue;
+        const size_t position = static_cast<size_t>(e.getElementAsInt32(POSITION[s]));
+        const double orders = numberOf(e, ORDERS[s]);
+        const BookLevel level{numberOf(e, PRICE[s]), numberOf(e, SIZE[s]),
+                              std::isnan(orders) ? 0 : static_cast<int>(orders)};
+        book.apply(static_cast<OrderBook::Side>(s), cmd, position, level);
+        applied = true;
+    }
+    return applied;
+}
+
+#endif
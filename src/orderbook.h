@@ -0,0 +1,75 @@
+// -*- mode: C++; c-indent-level: 4; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+//
+//  orderbook.h -- price-level order books built from market depth updates
+//
+//  Copyright (C) 2026  Whit Armstrong and Dirk Eddelbuettel
+//
+//  This file is part of Rblpapi
+//
+//  Rblpapi is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  Rblpapi is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Rblpapi.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <subscription.h>
+
+// one entry of a book: a price level for market-by-level books, an order (or
+// a broker quote) for market-by-order books
+struct BookLevel {
+    double price;
+    double size;
+    int orders;
+};
+
+// Book of one security as maintained by //blp/mktdepthdata: entries are
+// addressed by their one-based position on either side, best first, for
+// market-by-level as well as market-by-order tables. Each side is a single
+// contiguous vector so that the top of the book, which nearly all updates
+// touch, stays in one or two cache lines.
+class OrderBook {
+public:
+    enum Side { Bid = 0, Ask = 1 };
+    enum Command { Add, Modify, Delete, DeleteAll, DeleteBetter, DeleteSide, Execute, Replace, ClearAll, Ignore };
+
+    static Command command(const std::string& cmd);
+
+    void apply(Side side, Command cmd, size_t position, const BookLevel& level);
+    void clear();
+
+    const std::vector<BookLevel>& side(Side s) const { return sides[s]; }
+    bool empty() const { return sides[Bid].empty() && sides[Ask].empty(); }
+
+    double mid() const;
+    // size weighted mid of the best bid and ask
+    double microprice() const;
+    // (bid size - ask size) / (bid size + ask size) over the best 'levels' entries
+    double imbalance(size_t levels) const;
+
+    // book metrics as an update, in the order of metricNames()
+    void metrics(size_t levels, Update& u) const;
+    static std::vector<std::string> metricNames();
+
+private:
+    std::vector<BookLevel> sides[2];
+};
+
+#if defined(HaveBlp)
+#include <blpapi_message.h>
+
+// applies one MarketDepthUpdates message, returns false if it carried no book entry
+bool applyDepthMessage(const BloombergLP::blpapi::Message& msg, OrderBook& book);
+#endif
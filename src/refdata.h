@@ -0,0 +1,93 @@
+// -*- mode: C++; c-indent-level: 4; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+//
+//  refdata.h -- reference data requests shared by bdp and its batches
+//
+//  Copyright (C) 2026  Whit Armstrong and Dirk Eddelbuettel
+//
+//  This file is part of Rblpapi
+//
+//  Rblpapi is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  Rblpapi is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Rblpapi.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <blpapi_name.h>
+#include <blpapi_request.h>
+#include <blpapi_service.h>
+#include <requestengine.h>
+
+// Everything about a bdp but its securities: the fields with their column
+// index, and the options and overrides parsed from R, along with the column
+// types once known. Built per call, or once by bdpPrepare and shared by all
+// its executions.
+struct RefDataLayout {
+    RefDataLayout(const std::vector<std::string>& fields, SEXP options_, SEXP overrides_);
+    // the same with other overrides
+    RefDataLayout(const RefDataLayout& base, const std::vector<std::pair<std::string, std::string>>& overrides);
+    // the same for other fields, of known types
+    RefDataLayout(const RefDataLayout& base, const std::vector<std::string>& fields,
+                  const std::vector<RblpapiT>& rtypes);
+
+    void fill(BloombergLP::blpapi::Request& request, const std::vector<std::string>& securities) const;
+
+    std::vector<std::string> fields;
+    std::unordered_map<std::string, size_t> columns;
+    std::vector<std::pair<BloombergLP::blpapi::Name, std::string>> options;
+    std::vector<std::pair<std::string, std::string>> overrides;
+    std::vector<RblpapiT> rtypes;       // empty until resolved
+};
+
+// cells are decoded as the responses arrive and only copied into the
+// data.frame on the R thread once the request is complete
+class RefDataState : public TypedRequestState {
+public:
+    RefDataState(const std::vector<std::string>& securities, std::shared_ptr<const RefDataLayout> layout,
+                 const BloombergLP::blpapi::Service& fieldService, BloombergLP::blpapi::Request* request,
+                 bool verbose);
+    // with the types of a prepared layout
+    RefDataState(const std::vector<std::string>& securities, std::shared_ptr<const RefDataLayout> layout,
+                 BloombergLP::blpapi::Request* request, bool verbose);
+
+    SEXP materialize() override;
+
+    // copy the cells into the data.frame of a larger call, row i of this
+    // request going to row rows[i] there, or to row i if rows is empty
+    void fillInto(Rcpp::List& res, const std::vector<size_t>& rows);
+    // once complete
+    const FieldValue& cell(size_t row, size_t col) const { return cells[row * layout->fields.size() + col]; }
+
+protected:
+    void typesResolved(const std::vector<RblpapiT>& types) override { rtypes = types; }
+    void decodeData(const BloombergLP::blpapi::Message& msg) override;
+
+private:
+    std::vector<std::string> securities;
+    std::shared_ptr<const RefDataLayout> layout;
+    std::vector<RblpapiT> rtypes;
+    bool verbose;
+    std::vector<FieldValue> cells;      // row-major
+    std::ostringstream log;
+};
+
+// send a bdp without waiting for it, resolving the field types first unless
+// the layout has them
+std::shared_ptr<RequestState> bdpSubmit(RequestEngine& engine, const std::vector<std::string>& securities,
+                                        std::shared_ptr<const RefDataLayout> layout, bool verbose,
+                                        const BloombergLP::blpapi::Identity* identity);
@@ -0,0 +1,107 @@
+// -*- mode: C++; c-indent-level: 4; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+//
+//  replayJournal.cpp -- replay of recorded subscription journals
+//
+//  Copyright (C) 2026  Whit Armstrong and Dirk Eddelbuettel
+//
+//  This file is part of Rblpapi
+//
+//  Rblpapi is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  Rblpapi is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Rblpapi.  If not, see <http://www.gnu.org/licenses/>.
+
+// Replaying needs neither blpapi nor a session, so unlike the rest of the
+// package this file is compiled the same in builds without blp.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <journal.h>
+#include <subscription.h>
+
+// Replays a journal through the interface of subscribe(): one call of 'fun'
+// per update, or per batch of updates as a data.frame. Batch intervals are
+// measured in recorded time so that batches do not depend on replay speed;
+// 'speed' scales recorded time to wall-clock time, zero replays as fast as
+// possible. No session is involved.
+//
+// [[Rcpp::export]]
+Rcpp::List replayJournal_Impl(std::string journal, Rcpp::Function fun, double speed,
+                              int batchSize, int batchInterval, double startTime, double endTime) {
+    JournalReader reader(journal);
+    if (startTime > 0) reader.seek(startTime);
+    const std::vector<std::string>& topics = reader.topics();
+    const std::vector<std::string>& fields = reader.fields();
+
+    const bool batched = batchSize > 0 || batchInterval > 0;
+    const double interval = batchInterval / 1000.0;
+    UpdateBuffer buffer(fields.size(), batchSize > 0 ? batchSize : 1024);
+    double records = 0, batches = 0;
+    auto flush = [&]() {
+        if (buffer.size()) {
+            Rcpp::List df = updatesToDataFrame(buffer, topics, fields);
+            buffer.clear();
+            fun(df);
+            ++batches;
+        }
+    };
+
+    using clock = std::chrono::steady_clock;
+    const clock::time_point wallStart = clock::now();
+    double first = NAN, last = NAN, nextBatch = NAN;
+    Update u;
+    while (reader.next(u)) {
+        if (endTime > 0 && u.received >= endTime) break;
+        if (std::isnan(first)) {
+            first = u.received;
+            nextBatch = first + interval;
+        }
+        last = u.received;
+
+        if (speed > 0) {
+            // pace by recorded time, sleeping in short slices so that interrupts are seen
+            const clock::time_point due =
+                wallStart + std::chrono::duration_cast<clock::duration>(
+                    std::chrono::duration<double>((u.received - first) / speed));
+            for (clock::time_point now = clock::now(); now < due; now = clock::now()) {
+                std::this_thread::sleep_for(std::min<clock::duration>(due - now, std::chrono::milliseconds(10)));
+                Rcpp::checkUserInterrupt();
+            }
+        }
+
+        if (batched) {
+            if (batchInterval > 0 && u.received >= nextBatch) {
+                flush();
+                while (nextBatch <= u.received) nextBatch += interval;
+            }
+            buffer.append(u);
+            if (batchSize > 0 && buffer.size() >= static_cast<size_t>(batchSize)) flush();
+        } else if (u.topic >= 0 && static_cast<size_t>(u.topic) < topics.size()) {
+            Rcpp::List ans;
+            ans["event.type"] = "SUBSCRIPTION_DATA";
+            ans["topic"] = topics[u.topic];
+            ans["data"] = updateToList(u, fields);
+            fun(ans);
+        }
+        if (++records == 1 || std::fmod(records, 1000) == 0) Rcpp::checkUserInterrupt();
+    }
+    if (batched) flush();
+
+    const double elapsed = std::chrono::duration<double>(clock::now() - wallStart).count();
+    return Rcpp::List::create(Rcpp::Named("records") = records,
+                              Rcpp::Named("batches") = batches,
+                              Rcpp::Named("elapsed") = elapsed,
+                              Rcpp::Named("rate") = elapsed > 0 ? records / elapsed : NA_REAL,
+                              Rcpp::Named("start") = createPOSIXtVector(std::vector<double>(1, first)),
+                              Rcpp::Named("end") = createPOSIXtVector(std::vector<double>(1, last)));
+}
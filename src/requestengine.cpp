@@ -0,0 +1,672 @@
+// -*- mode: C++; c-indent-level: 4; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+//
+//  requestengine.cpp -- requests routed to their decoders by correlation id
+//
+//  Copyright (C) 2026  Whit Armstrong and Dirk Eddelbuettel
+//
+//  This file is part of Rblpapi
+//
+//  Rblpapi is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  Rblpapi is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Rblpapi.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#if defined(HaveBlp)
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include <unordered_set>
+#include <blpapi_exception.h>
+#include <blpapi_utils.h>
+#include <connectionpool.h>
+#include <eventrouter.h>
+#include <requestengine.h>
+
+namespace bbg = BloombergLP::blpapi;
+
+namespace {
+    const bbg::Name SESSION_STARTED("SessionStarted");
+    const bbg::Name SESSION_STARTUP_FAILURE("SessionStartupFailure");
+    const bbg::Name SESSION_TERMINATED("SessionTerminated");
+    const bbg::Name REQUEST_FAILURE("RequestFailure");
+    const bbg::Name REASON("reason");
+    const bbg::Name DESCRIPTION("description");
+    const bbg::Name FIELD_DATA("fieldData");
+    const bbg::Name FIELD_INFO("fieldInfo");
+    const bbg::Name FIELD_ERROR("fieldError");
+    const bbg::Name ID("id");
+    const bbg::Name MNEMONIC("mnemonic");
+    const bbg::Name DATATYPE("datatype");
+    const bbg::Name FTYPE("ftype");
+
+    // process-wide so that stale events of a request abandoned on a
+    // synchronous session can never be taken for those of a later one
+    std::atomic<long long> nextId{1};
+
+    long long steadyMillis() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    std::string reasonOf(const bbg::Message& msg) {
+        bbg::Element e = msg.asElement();
+        if (e.hasElement(REASON) && e.getElement(REASON).hasElement(DESCRIPTION)) {
+            return e.getElement(REASON).getElementAsString(DESCRIPTION);
+        }
+        return "Request failed.";
+    }
+
+    std::string upper(std::string s) {
+        std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::toupper(c); });
+        return s;
+    }
+
+    // fields repeated in a request are looked up once
+    std::vector<std::string> distinctFields(const std::vector<std::string>& fields) {
+        std::vector<std::string> res;
+        std::unordered_set<std::string> seen;
+        for (const auto& f : fields) {
+            if (seen.insert(upper(f)).second) res.push_back(f);
+        }
+        return res;
+    }
+
+    // the types of the fields in their order; the infos answering a
+    // FieldInfoRequest are matched by id or mnemonic rather than position,
+    // as nothing promises they come back one per field and in order
+    std::vector<RblpapiT> typesByName(const std::vector<std::string>& fields, const std::vector<FieldInfo>& infos) {
+        std::unordered_map<std::string, RblpapiT> types;
+        for (const auto& f : infos) {
+            const RblpapiT t = fieldInfoToRblpapiT(f.datatype, f.ftype);
+            types.emplace(upper(f.id), t);
+            types.emplace(upper(f.mnemonic), t);
+        }
+        std::vector<RblpapiT> rtypes;
+        for (const auto& f : fields) {
+            auto it = types.find(upper(f));
+            if (it == types.end()) {
+                throw std::runtime_error("No field type returned for '" + f + "'.");
+            }
+            rtypes.push_back(it->second);
+        }
+        return rtypes;
+    }
+}
+
+RequestStatistics& requestStatistics() {
+    static RequestStatistics stats;
+    return stats;
+}
+
+FieldInfo fieldInfoFromElement(const bbg::Element& field) {
+    if (!field.hasElement(ID)) {
+        throw std::runtime_error("Did not find 'id' in repsonse.");
+    }
+    if (field.hasElement(FIELD_ERROR)) {
+        throw std::runtime_error(std::string("Bad field: ") + field.getElementAsString(ID));
+    }
+    if (!field.hasElement(FIELD_INFO)) {
+        throw std::runtime_error("Did not find fieldInfo in repsonse.");
+    }
+    bbg::Element fieldInfo = field.getElement(FIELD_INFO);
+    if (!fieldInfo.hasElement(MNEMONIC) || !fieldInfo.hasElement(DATATYPE) ||
+        !fieldInfo.hasElement(FTYPE)) {
+        throw std::runtime_error("fieldInfo missing info mnemonic/datatype/ftype.");
+    }
+    FieldInfo f;
+    f.id = field.getElementAsString(ID);
+    f.mnemonic = fieldInfo.getElementAsString(MNEMONIC);
+    f.datatype = fieldInfo.getElementAsString(DATATYPE);
+    f.ftype = fieldInfo.getElementAsString(FTYPE);
+    return f;
+}
+
+void RequestState::deliver(const bbg::Message& msg, bool last) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (status_ != Pending) return;
+        ++inflight;
+    }
+    ++messages_;
+    ++requestStatistics().messages;
+    try {
+        std::lock_guard<std::mutex> lock(decodeMutex);
+        decode(msg);
+        if (last) finished(msg.correlationId().asInteger());
+    } catch (const bbg::Exception& e) {
+        fail(e.description());
+    } catch (const std::exception& e) {
+        fail(e.what());
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    --inflight;
+    if (last && outstanding > 0) --outstanding;
+    // with several dispatcher threads a partial response may still be
+    // decoded on another thread when the final one arrives; follow-up
+    // requests were counted before the one they follow is discounted
+    if (outstanding == 0 && inflight == 0 && status_ == Pending) {
+        settle(Complete);
+    }
+}
+
+bool RequestState::begin(RequestEngine* e) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (status_ != Pending) return false;
+    if (requests_ == 0) started = std::chrono::steady_clock::now();
+    engine = e;
+    ++outstanding;
+    ++requests_;
+    return true;
+}
+
+void RequestState::abandon() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (outstanding > 0) --outstanding;
+}
+
+long long RequestState::send(const bbg::Request& request, const bbg::Identity* identity) {
+    // a follow-up is part of a request already admitted by the throttle
+    return engine->submit(request, shared_from_this(), identity);
+}
+
+void RequestState::settle(Status s) {
+    status_ = s;
+    stopped = std::chrono::steady_clock::now();
+    RequestStatistics& stats = requestStatistics();
+    switch (s) {
+    case Complete: ++stats.completed; break;
+    case Failed: ++stats.failed; break;
+    default: ++stats.cancelled; break;
+    }
+    if (requests_ > 0) {
+        stats.micros += std::chrono::duration_cast<std::chrono::microseconds>(stopped - started).count();
+    }
+    done.notify_all();
+}
+
+void RequestState::finish(Status s, const std::string& reason) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (status_ != Pending) return;
+    error_ = reason;
+    settle(s);
+}
+
+void RequestState::fail(const std::string& reason) {
+    finish(Failed, reason);
+}
+
+void RequestState::cancel(const std::string& reason) {
+    finish(Cancelled, reason);
+}
+
+bool RequestState::wait(int timeout) {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto finished = [this]() { return status_ != Pending; };
+    if (timeout <= 0) {
+        done.wait(lock, finished);
+        return true;
+    }
+    return done.wait_for(lock, std::chrono::milliseconds(timeout), finished);
+}
+
+RequestState::Status RequestState::status() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return status_;
+}
+
+std::string RequestState::error() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return error_;
+}
+
+double RequestState::elapsed() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (requests_ == 0) return 0.0;
+    const auto end = status_ == Pending ? std::chrono::steady_clock::now() : stopped;
+    return std::chrono::duration<double>(end - started).count();
+}
+
+TypedRequestState::TypedRequestState(const std::vector<std::string>& fields, const bbg::Service& fieldService,
+                                     bbg::Request* data)
+    : fields(fields), fieldService(fieldService), data(data) {
+}
+
+TypedRequestState::TypedRequestState(const std::vector<RblpapiT>& rtypes, bbg::Request* data)
+    : data(data), known(true), knownTypes(rtypes) {
+}
+
+void TypedRequestState::start(RequestEngine& engine, const bbg::Identity* identity) {
+    this->identity = identity;
+    if (known) {
+        typesResolved(knownTypes);
+        engine.send(*data, shared_from_this(), identity);
+        return;
+    }
+    bbg::Request request = fieldService.createRequest("FieldInfoRequest");
+    for (const auto& f : distinctFields(fields)) {
+        request.append(ID, f.c_str());
+    }
+    request.set(bbg::Name{"returnFieldDocumentation"}, false);
+    infoId = engine.send(request, shared_from_this());
+}
+
+void TypedRequestState::decode(const bbg::Message& msg) {
+    if (msg.correlationId().asInteger() != infoId) {
+        decodeData(msg);
+        return;
+    }
+    bbg::Element fieldData = msg.getElement(FIELD_DATA);
+    for (size_t i = 0; i < fieldData.numValues(); ++i) {
+        infos.push_back(fieldInfoFromElement(fieldData.getValueAsElement(i)));
+    }
+}
+
+void TypedRequestState::finished(long long id) {
+    if (id != infoId) return;
+    typesResolved(typesByName(fields, infos));
+    send(*data, identity);
+}
+
+long long RequestEngine::send(const bbg::Request& request, std::shared_ptr<RequestState> state,
+                              const bbg::Identity* identity) {
+    if (throttle_ != nullptr) {
+        bool retry = false;
+        while (!throttle_->admit(pending(), retry)) {
+            retry = true;
+            waitAny(100);
+            Rcpp::checkUserInterrupt();
+        }
+    }
+    return submit(request, state, identity);
+}
+
+long long RequestEngine::submit(const bbg::Request& request, std::shared_ptr<RequestState> state,
+                                const bbg::Identity* identity) {
+    const long long id = newCorrelationId();
+    {
+        // registered first, the response may arrive before sendRequest returns
+        std::lock_guard<std::mutex> lock(mutex);
+        if (sessionState == Down) {
+            throw std::runtime_error("Session is down.");
+        }
+        if (!state->begin(this)) {
+            return 0;                   // cancelled or failed meanwhile, nothing to send for
+        }
+        requests.emplace(id, Outstanding{state, steadyMillis()});
+    }
+    try {
+        sendRequest(request, bbg::CorrelationId(id), identity);
+    } catch (const bbg::Exception& e) {
+        take(id);
+        state->abandon();
+        throw std::runtime_error(e.description());
+    }
+    ++sent_;
+    ++requestStatistics().sent;
+    return id;
+}
+
+void RequestEngine::cancel(const std::shared_ptr<RequestState>& state) {
+    release(state);
+    state->cancel();
+}
+
+void RequestEngine::release(const std::shared_ptr<RequestState>& state) {
+    std::vector<long long> ids;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = requests.begin(); it != requests.end(); ) {
+            if (it->second.state == state) {
+                ids.push_back(it->first);
+                it = requests.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        slots.notify_all();
+    }
+    for (long long id : ids) {
+        cancelRequest(bbg::CorrelationId(id));
+    }
+}
+
+bool RequestEngine::up() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return sessionState == Running;
+}
+
+double RequestEngine::sinceFailure() const {
+    const long long t = lastFailure.load();
+    if (t == 0) return -1.0;
+    return (steadyMillis() - t) / 1000.0;
+}
+
+size_t RequestEngine::pending() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return requests.size();
+}
+
+std::vector<long long> RequestEngine::pendingIds() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<long long> ids;
+    for (const auto& r : requests) ids.push_back(r.first);
+    return ids;
+}
+
+void RequestEngine::await(const std::shared_ptr<RequestState>& state) {
+    try {
+        // short slices so that interrupts are seen
+        while (!waitFor(state, 100)) {
+            Rcpp::checkUserInterrupt();
+        }
+    } catch (const Rcpp::internal::InterruptedException&) {
+        cancel(state);
+        throw;
+    }
+    if (state->status() != RequestState::Complete) {
+        Rcpp::stop(state->error());
+    }
+}
+
+RequestEngine::Outstanding RequestEngine::take(long long id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = requests.find(id);
+    if (it == requests.end()) return Outstanding{nullptr, 0};
+    Outstanding o = it->second;
+    requests.erase(it);
+    slots.notify_all();
+    return o;
+}
+
+void RequestEngine::waitAny(int timeout) {
+    std::unique_lock<std::mutex> lock(mutex);
+    slots.wait_for(lock, std::chrono::milliseconds(timeout));
+}
+
+void RequestEngine::failAll(const std::string& reason) {
+    std::unordered_map<long long, Outstanding> failed;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        failed.swap(requests);
+        slots.notify_all();
+    }
+    for (auto& r : failed) {
+        r.second.state->fail(reason);
+    }
+}
+
+void RequestEngine::route(const bbg::Event& event) {
+    bbg::MessageIterator msgIter(event);
+    switch (event.eventType()) {
+    case bbg::Event::RESPONSE:
+    case bbg::Event::PARTIAL_RESPONSE: {
+        const bool last = event.eventType() == bbg::Event::RESPONSE;
+        while (msgIter.next()) {
+            bbg::Message msg = msgIter.message();
+            const long long id = msg.correlationId().asInteger();
+            std::shared_ptr<RequestState> s;
+            if (last) {
+                Outstanding o = take(id);
+                s = o.state;
+                if (s) {
+                    failureStreak_ = 0;
+                    if (throttle_ != nullptr) throttle_->succeeded((steadyMillis() - o.sentAt) / 1000.0);
+                }
+            } else {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto it = requests.find(id);
+                if (it != requests.end()) s = it->second.state;
+            }
+            if (!s) continue;               // anything else is stale or not ours
+            s->deliver(msg, last);
+            // a state failed by its decoder keeps no other request in flight
+            if (s->status() == RequestState::Failed) release(s);
+        }
+        break;
+    }
+    case bbg::Event::REQUEST_STATUS:
+        while (msgIter.next()) {
+            bbg::Message msg = msgIter.message();
+            if (msg.messageType() != REQUEST_FAILURE) continue;
+            std::shared_ptr<RequestState> s = take(msg.correlationId().asInteger()).state;
+            if (!s) continue;
+            ++failureStreak_;
+            lastFailure = steadyMillis();
+            if (throttle_ != nullptr) throttle_->failed();
+            s->fail(reasonOf(msg));
+            // the other requests of the state, e.g. further batches, are of no use now
+            release(s);
+        }
+        break;
+    case bbg::Event::SESSION_STATUS:
+        while (msgIter.next()) {
+            bbg::Message msg = msgIter.message();
+            if (msg.messageType() == SESSION_STARTED) {
+                std::lock_guard<std::mutex> lock(mutex);
+                sessionState = Running;
+                started.notify_all();
+            } else if (msg.messageType() == SESSION_STARTUP_FAILURE ||
+                       msg.messageType() == SESSION_TERMINATED) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    sessionState = Down;
+                    started.notify_all();
+                }
+                failAll("Session terminated.");
+            }
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+SyncRequestEngine::~SyncRequestEngine() {
+    // left behind by an error or an interrupt; their late responses are
+    // dropped by whichever engine sees them next as they match no request
+    for (long long id : pendingIds()) {
+        try {
+            session->cancel(bbg::CorrelationId(id));
+        } catch (...) {
+            // nothing sensible left to do
+        }
+    }
+}
+
+bbg::Service SyncRequestEngine::service(const std::string& name) {
+    if (context != nullptr) return context->open(*session, name);
+    if (!session->openService(name.c_str())) {
+        throw std::runtime_error("Failed to open " + name);
+    }
+    return session->getService(name.c_str());
+}
+
+void SyncRequestEngine::sendRequest(const bbg::Request& request, const bbg::CorrelationId& cid,
+                                    const bbg::Identity* identity) {
+    if (identity != nullptr) {
+        session->sendRequest(request, *identity, cid);
+    } else {
+        session->sendRequest(request, cid);
+    }
+}
+
+void SyncRequestEngine::cancelRequest(const bbg::CorrelationId& cid) {
+    session->cancel(cid);
+}
+
+void SyncRequestEngine::waitAny(int timeout) {
+    bbg::Event event = session->nextEvent(timeout);
+    if (event.eventType() != bbg::Event::TIMEOUT) {
+        route(event);
+    }
+}
+
+bool SyncRequestEngine::waitFor(const std::shared_ptr<RequestState>& state, int timeout) {
+    if (state->status() != RequestState::Pending) return true;
+    bbg::Event event = session->nextEvent(timeout);
+    if (event.eventType() != bbg::Event::TIMEOUT) {
+        route(event);
+    }
+    return state->status() != RequestState::Pending;
+}
+
+long long newCorrelationId() {
+    return nextId++;
+}
+
+ConnectionEngine::ConnectionEngine(SEXP con_, const std::string& key) {
+    if (ConnectionPool* pool = poolFromConnection(con_)) {
+        engine = &pool->select(key);
+        return;
+    }
+    engine = routerFromConnection(con_);
+    if (engine == nullptr) {
+        bbg::Session* session =
+            reinterpret_cast<bbg::Session*>(checkExternalPointer(con_, "blpapi::Session*"));
+        sync.reset(new SyncRequestEngine(session, sessionContext(con_)));
+        engine = sync.get();
+    }
+}
+
+ConnectionEngine::ConnectionEngine(SEXP con_, const std::vector<std::string>& securities)
+    : ConnectionEngine(con_, securities.empty() ? std::string() : securities.front()) {
+}
+
+const bbg::Identity* ConnectionEngine::identity(SEXP identity_) const {
+    if (identity_ == R_NilValue) return nullptr;
+    if (!sync) {
+        Rcpp::stop("Identities are tied to a synchronous session and cannot be used here.");
+    }
+    return reinterpret_cast<bbg::Identity*>(checkExternalPointer(identity_, "blpapi::Identity*"));
+}
+
+std::vector<bbg::Message> ConnectionEngine::request(const bbg::Request& request, SEXP identity_) {
+    auto state = std::make_shared<BufferedRequestState>();
+    engine->send(request, state, identity(identity_));
+    engine->await(state);
+    return state->responses();
+}
+
+std::vector<Throttle*> connectionThrottles(SEXP con_) {
+    std::vector<Throttle*> res;
+    if (ConnectionPool* pool = poolFromConnection(con_)) {
+        for (const auto& m : pool->members()) res.push_back(m.router->throttle());
+    } else if (EventRouter* router = routerFromConnection(con_)) {
+        res.push_back(router->throttle());
+    } else {
+        checkExternalPointer(con_, "blpapi::Session*");
+        if (SessionContext* context = sessionContext(con_)) res.push_back(&context->throttle());
+    }
+    return res;
+}
+
+std::vector<RblpapiT> fieldTypes(ConnectionEngine& engine, const std::vector<std::string>& fields) {
+    bbg::Request request = engine->service("//blp/apiflds").createRequest("FieldInfoRequest");
+    for (const auto& f : distinctFields(fields)) {
+        request.append(ID, f.c_str());
+    }
+    request.set(bbg::Name{"returnFieldDocumentation"}, false);
+    std::vector<FieldInfo> infos;
+    for (const auto& msg : engine.request(request)) {
+        bbg::Element fieldData = msg.getElement(FIELD_DATA);
+        for (size_t i = 0; i < fieldData.numValues(); ++i) {
+            infos.push_back(fieldInfoFromElement(fieldData.getValueAsElement(i)));
+        }
+    }
+    return typesByName(fields, infos);
+}
+
+#else
+#include <Rcpp/Lightest>
+#endif
+
+// [[Rcpp::export]]
+Rcpp::List requestStatistics_Impl(bool reset) {
+#if defined(HaveBlp)
+    RequestStatistics& stats = requestStatistics();
+    const double finished = stats.completed + stats.failed + stats.cancelled;
+    Rcpp::List ans = Rcpp::List::create(Rcpp::Named("sent") = static_cast<double>(stats.sent),
+                                        Rcpp::Named("messages") = static_cast<double>(stats.messages),
+                                        Rcpp::Named("completed") = static_cast<double>(stats.completed),
+                                        Rcpp::Named("failed") = static_cast<double>(stats.failed),
+                                        Rcpp::Named("cancelled") = static_cast<double>(stats.cancelled),
+                                        Rcpp::Named("meanSeconds") = finished > 0 ? stats.micros / finished / 1e6
+                                                                                  : NA_REAL);
+    if (reset) {
+        stats.sent = 0;
+        stats.messages = 0;
+        stats.completed = 0;
+        stats.failed = 0;
+        stats.cancelled = 0;
+        stats.micros = 0;
+    }
+    return ans;
+#else // ie no Blp
+    return Rcpp::List();
+#endif
+}
+
+// [[Rcpp::export]]
+SEXP setThrottle_Impl(SEXP con_, bool enabled, double rate, double burst, double minWindow, double maxWindow,
+                      double latency, double minCells, double maxCells) {
+#if defined(HaveBlp)
+    Throttle::Settings settings;
+    settings.enabled = enabled;
+    settings.rate = rate;
+    settings.burst = burst;
+    settings.minWindow = minWindow;
+    settings.maxWindow = maxWindow;
+    settings.latency = latency;
+    settings.minCells = minCells;
+    settings.maxCells = maxCells;
+    for (Throttle* t : connectionThrottles(con_)) t->configure(settings);
+#endif
+    return R_NilValue;
+}
+
+// [[Rcpp::export]]
+Rcpp::DataFrame throttleStatus_Impl(SEXP con_, bool reset) {
+#if defined(HaveBlp)
+    std::vector<Throttle*> throttles = connectionThrottles(con_);
+    const size_t n = throttles.size();
+    std::vector<bool> enabled(n);
+    std::vector<double> window(n), cells(n), latency(n), admitted(n), delayed(n), increases(n),
+        decreases(n), failures(n), slow(n);
+    for (size_t i = 0; i < n; ++i) {
+        const Throttle::Counters c = throttles[i]->counters();
+        enabled[i] = throttles[i]->settings().enabled;
+        window[i] = throttles[i]->window();
+        cells[i] = static_cast<double>(throttles[i]->cells());
+        latency[i] = throttles[i]->meanLatency();
+        admitted[i] = static_cast<double>(c.admitted);
+        delayed[i] = static_cast<double>(c.delayed);
+        increases[i] = static_cast<double>(c.increases);
+        decreases[i] = static_cast<double>(c.decreases);
+        failures[i] = static_cast<double>(c.failures);
+        slow[i] = static_cast<double>(c.slow);
+        if (reset) throttles[i]->reset();
+    }
+    return Rcpp::DataFrame::create(Rcpp::Named("enabled") = enabled,
+                                   Rcpp::Named("window") = window,
+                                   Rcpp::Named("cells") = cells,
+                                   Rcpp::Named("latency") = latency,
+                                   Rcpp::Named("admitted") = admitted,
+                                   Rcpp::Named("delayed") = delayed,
+                                   Rcpp::Named("increases") = increases,
+                                   Rcpp::Named("decreases") = decreases,
+                                   Rcpp::Named("failures") = failures,
+                                   Rcpp::Named("slow") = slow);
+#else // ie no Blp
+    return Rcpp::DataFrame();
+#endif
+}
@@ -0,0 +1,308 @@
+// -*- mode: C++; c-indent-level: 4; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+//
+//  requestengine.h -- requests routed to their decoders by correlation id
+//
+//  Copyright (C) 2026  Whit Armstrong and Dirk Eddelbuettel
+//
+//  This file is part of Rblpapi
+//
+//  Rblpapi is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  Rblpapi is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Rblpapi.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <blpapi_correlationid.h>
+#include <blpapi_element.h>
+#include <blpapi_event.h>
+#include <blpapi_identity.h>
+#include <blpapi_message.h>
+#include <blpapi_request.h>
+#include <blpapi_service.h>
+#include <blpapi_session.h>
+#include <Rcpp.h>
+#include <Rblpapi_types.h>
+#include <sessioncontext.h>
+#include <subscription.h>
+
+class RequestEngine;
+
+// Decoder state of one logical request, which may take several requests to
+// the server. Messages are handed to decode() one at a time per state, on a
+// dispatcher thread of a routed connection or on the R thread otherwise, so
+// implementations stage what they decode in plain C++ without touching R; the
+// R thread turns the staged result into R objects once the state is complete,
+// i.e. once every request sent for it has received its final response.
+// Follow-up requests can be sent from decode() or finished(). Errors are
+// thrown as std::exception and fail the state.
+class RequestState : public std::enable_shared_from_this<RequestState> {
+public:
+    enum Status { Pending, Complete, Failed, Cancelled };
+
+    virtual ~RequestState() {}
+
+    // 'last' for the message of the final RESPONSE event
+    void deliver(const BloombergLP::blpapi::Message& msg, bool last);
+    void fail(const std::string& reason);
+    void cancel(const std::string& reason = "Request cancelled.");
+
+    // any thread; wait returns whether the state is finished, a timeout
+    // of zero (in milliseconds) waits indefinitely
+    bool wait(int timeout);
+    Status status() const;
+    std::string error() const;
+    size_t messages() const { return messages_.load(); }
+    size_t requests() const { return requests_.load(); }
+    // seconds from the first request sent to completion, or until now
+    double elapsed() const;
+
+    // R thread, once complete
+    virtual SEXP materialize() { return R_NilValue; }
+
+protected:
+    virtual void decode(const BloombergLP::blpapi::Message& msg) = 0;
+    // after the final message of the request sent under 'id' was decoded
+    virtual void finished(long long id) {}
+    // send a follow-up request routed to this state
+    long long send(const BloombergLP::blpapi::Request& request,
+                   const BloombergLP::blpapi::Identity* identity = nullptr);
+
+private:
+    friend class RequestEngine;
+    bool begin(RequestEngine* e);       // counts a request sent through e
+    void abandon();                     // the request counted could not be sent
+    void finish(Status s, const std::string& reason);
+    void settle(Status s);              // with the lock held
+
+    RequestEngine* engine = nullptr;
+    std::mutex decodeMutex;             // serialises decode() across dispatcher threads
+    mutable std::mutex mutex;           // guards the members below
+    std::condition_variable done;
+    Status status_ = Pending;
+    std::string error_;
+    size_t inflight = 0;                // messages being decoded right now
+    size_t outstanding = 0;             // requests without their final response
+    std::chrono::steady_clock::time_point started, stopped;
+    std::atomic<size_t> messages_{0};
+    std::atomic<size_t> requests_{0};
+};
+
+// A state that keeps the messages answering it, in the order they arrived,
+// and leaves their decoding to the R thread once complete; for results that
+// are built directly as R objects.
+class BufferedRequestState : public RequestState {
+public:
+    const std::vector<BloombergLP::blpapi::Message>& responses() const { return responses_; }
+
+protected:
+    void decode(const BloombergLP::blpapi::Message& msg) override { responses_.push_back(msg); }
+
+private:
+    std::vector<BloombergLP::blpapi::Message> responses_;
+};
+
+// A state that first resolves the types of its fields through //blp/apiflds
+// and only then sends its data request, from the thread decoding the field
+// types, so that submitting it does not wait for them.
+class TypedRequestState : public RequestState {
+public:
+    // fields to resolve, and the data request to send once they are
+    TypedRequestState(const std::vector<std::string>& fields, const BloombergLP::blpapi::Service& fieldService,
+                      BloombergLP::blpapi::Request* data);
+    // types known beforehand, as for a prepared request, so that start()
+    // sends the data request right away
+    TypedRequestState(const std::vector<RblpapiT>& rtypes, BloombergLP::blpapi::Request* data);
+    // the identity, if any, must outlive the state
+    void start(RequestEngine& engine, const BloombergLP::blpapi::Identity* identity = nullptr);
+
+protected:
+    void decode(const BloombergLP::blpapi::Message& msg) override;
+    void finished(long long id) override;
+    // types of the requested fields in order, to be kept by the
+    // implementation along with any columns it adds
+    virtual void typesResolved(const std::vector<RblpapiT>& rtypes) = 0;
+    virtual void decodeData(const BloombergLP::blpapi::Message& msg) = 0;
+
+private:
+    std::vector<std::string> fields;
+    BloombergLP::blpapi::Service fieldService;
+    std::unique_ptr<BloombergLP::blpapi::Request> data;
+    const BloombergLP::blpapi::Identity* identity = nullptr;
+    long long infoId = 0;
+    std::vector<FieldInfo> infos;
+    bool known = false;
+    std::vector<RblpapiT> knownTypes;
+};
+
+// Sends requests under correlation ids of their own and routes the events
+// answering them to their RequestState, so that any number of requests can be
+// in flight on one session. Request failures, session status and interrupts
+// are handled here, alike for every request; how events reach route() is left
+// to the implementations.
+class RequestEngine {
+public:
+    virtual ~RequestEngine() {}
+
+    // R thread
+    virtual BloombergLP::blpapi::Service service(const std::string& name) = 0;
+
+    // returns the correlation id the request was sent under, or zero if
+    // the state was finished meanwhile; waits, on the R thread, until the
+    // throttle if any admits the request; throws std::runtime_error
+    long long send(const BloombergLP::blpapi::Request& request, std::shared_ptr<RequestState> state,
+                   const BloombergLP::blpapi::Identity* identity = nullptr);
+    // cancel all requests of a state
+    void cancel(const std::shared_ptr<RequestState>& state);
+    size_t pending() const;
+
+    // health as seen from the events: whether the session is up, requests
+    // sent, and requests the server failed in a row since the last response
+    bool up() const;
+    unsigned long long sent() const { return sent_.load(); }
+    unsigned failureStreak() const { return failureStreak_.load(); }
+    // seconds since the last request failure, or a negative number if none
+    double sinceFailure() const;
+    // limits on the requests in flight, or nullptr
+    Throttle* throttle() const { return throttle_; }
+
+    // R thread; wait for a state, checking for interrupts, which cancel it,
+    // and stop with the error of a failed state
+    void await(const std::shared_ptr<RequestState>& state);
+
+protected:
+    enum SessionState { Starting, Running, Down };
+    RequestEngine(SessionState initial, Throttle* throttle) : sessionState(initial), throttle_(throttle) {}
+
+    virtual void sendRequest(const BloombergLP::blpapi::Request& request,
+                             const BloombergLP::blpapi::CorrelationId& cid,
+                             const BloombergLP::blpapi::Identity* identity) = 0;
+    virtual void cancelRequest(const BloombergLP::blpapi::CorrelationId& cid) = 0;
+    // R thread; wait up to 'timeout' milliseconds for the state to finish
+    virtual bool waitFor(const std::shared_ptr<RequestState>& state, int timeout) = 0;
+    // R thread; wait up to 'timeout' milliseconds for any request to finish
+    virtual void waitAny(int timeout);
+
+    void route(const BloombergLP::blpapi::Event& event);
+    void failAll(const std::string& reason);
+    std::vector<long long> pendingIds() const;
+
+    mutable std::mutex mutex;           // guards the members below
+    std::condition_variable started;
+    SessionState sessionState;
+
+private:
+    friend class RequestState;
+    struct Outstanding {
+        std::shared_ptr<RequestState> state;
+        long long sentAt;               // steady clock, in milliseconds
+    };
+
+    // send without asking the throttle
+    long long submit(const BloombergLP::blpapi::Request& request, std::shared_ptr<RequestState> state,
+                     const BloombergLP::blpapi::Identity* identity);
+    Outstanding take(long long id);
+    // drop and cancel the requests of a state still in flight, leaving its status
+    void release(const std::shared_ptr<RequestState>& state);
+
+    std::unordered_map<long long, Outstanding> requests;
+    std::condition_variable slots;      // signalled whenever a request leaves 'requests'
+    Throttle* throttle_;
+
+    std::atomic<unsigned long long> sent_{0};
+    std::atomic<unsigned> failureStreak_{0};
+    std::atomic<long long> lastFailure{0};  // steady clock, in milliseconds
+};
+
+// The engine of a synchronous session: events are pumped with nextEvent() on
+// the R thread while waiting for a state. Meant to live for one call, during
+// which R has the session to itself; requests still pending when it goes are
+// cancelled.
+class SyncRequestEngine : public RequestEngine {
+public:
+    // the context, if any, keeps the services opened across calls
+    SyncRequestEngine(BloombergLP::blpapi::Session* session, SessionContext* context)
+        : RequestEngine(Running, context ? &context->throttle() : nullptr), session(session), context(context) {}
+    ~SyncRequestEngine();
+
+    BloombergLP::blpapi::Service service(const std::string& name) override;
+
+protected:
+    void sendRequest(const BloombergLP::blpapi::Request& request,
+                     const BloombergLP::blpapi::CorrelationId& cid,
+                     const BloombergLP::blpapi::Identity* identity) override;
+    void cancelRequest(const BloombergLP::blpapi::CorrelationId& cid) override;
+    bool waitFor(const std::shared_ptr<RequestState>& state, int timeout) override;
+    void waitAny(int timeout) override;
+
+private:
+    BloombergLP::blpapi::Session* session;
+    SessionContext* context;
+};
+
+// The engine requests on a connection go through: the router of a connection
+// created with dispatcher threads, one of the routers of a pool, or a
+// SyncRequestEngine over the session of any other connection, for as long as
+// this object lives.
+class ConnectionEngine {
+public:
+    // the key, usually a security, selects the session of a pool balanced
+    // by security
+    explicit ConnectionEngine(SEXP con_, const std::string& key = std::string());
+    ConnectionEngine(SEXP con_, const std::vector<std::string>& securities);
+
+    RequestEngine& operator*() const { return *engine; }
+    RequestEngine* operator->() const { return engine; }
+    bool routed() const { return !sync; }
+
+    // the identity of an authenticated synchronous session, or nullptr
+    const BloombergLP::blpapi::Identity* identity(SEXP identity_) const;
+
+    // send a request and wait for the messages answering it
+    std::vector<BloombergLP::blpapi::Message> request(const BloombergLP::blpapi::Request& request,
+                                                      SEXP identity_ = R_NilValue);
+
+private:
+    std::unique_ptr<SyncRequestEngine> sync;
+    RequestEngine* engine;
+};
+
+// correlation ids are unique across all sessions of the process
+long long newCorrelationId();
+
+// the throttles of the sessions behind a connection
+std::vector<Throttle*> connectionThrottles(SEXP con_);
+
+// R thread; the types of fields, looked up through //blp/apiflds
+std::vector<RblpapiT> fieldTypes(ConnectionEngine& engine, const std::vector<std::string>& fields);
+
+FieldInfo fieldInfoFromElement(const BloombergLP::blpapi::Element& field);
+
+// counters over all requests of the process
+struct RequestStatistics {
+    std::atomic<unsigned long long> sent{0};        // requests sent to the server
+    std::atomic<unsigned long long> messages{0};    // response messages decoded
+    std::atomic<unsigned long long> completed{0};   // states by final status
+    std::atomic<unsigned long long> failed{0};
+    std::atomic<unsigned long long> cancelled{0};
+    std::atomic<unsigned long long> micros{0};      // total time to completion
+};
+
+RequestStatistics& requestStatistics();
@@ -0,0 +1,133 @@
+// -*- mode: C++; c-indent-level: 4; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+//
+//  sessioncontext.cpp -- services kept open for the life of a session
+//
+//  Copyright (C) 2026  Whit Armstrong and Dirk Eddelbuettel
+//
+//  This file is part of Rblpapi
+//
+//  Rblpapi is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  Rblpapi is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Rblpapi.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#if defined(HaveBlp)
+
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <blpapi_correlationid.h>
+#include <blpapi_event.h>
+#include <blpapi_message.h>
+#include <blpapi_utils.h>
+#include <finalizers.h>
+#include <requestengine.h>
+#include <sessioncontext.h>
+
+namespace bbg = BloombergLP::blpapi;
+
+namespace {
+    const bbg::Name SERVICE_OPENED("ServiceOpened");
+    const bbg::Name SERVICE_OPEN_FAILURE("ServiceOpenFailure");
+
+    void contextFinalizer(SEXP context_) {
+        SessionContext* context = reinterpret_cast<SessionContext*>(R_ExternalPtrAddr(context_));
+        if (context) {
+            delete context;
+            R_ClearExternalPtr(context_);
+        }
+    }
+}
+
+bool SessionContext::find(const std::string& name, bbg::Service& service) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = services_.find(name);
+    if (it == services_.end()) return false;
+    service = it->second;
+    return true;
+}
+
+void SessionContext::add(const std::string& name, const bbg::Service& service) {
+    std::lock_guard<std::mutex> lock(mutex);
+    services_.emplace(name, service);
+}
+
+std::vector<std::string> SessionContext::services() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string> names;
+    for (const auto& s : services_) names.push_back(s.first);
+    return names;
+}
+
+bbg::Service SessionContext::open(bbg::Session& session, const std::string& name) {
+    bbg::Service s;
+    if (find(name, s)) return s;
+    if (!session.openService(name.c_str())) {
+        throw std::runtime_error("Failed to open " + name);
+    }
+    s = session.getService(name.c_str());
+    add(name, s);
+    return s;
+}
+
+std::vector<std::string> SessionContext::warmUp(bbg::Session& session, const std::vector<std::string>& names,
+                                                int timeout) {
+    std::unordered_map<long long, std::string> opening;
+    for (const auto& name : names) {
+        bbg::Service s;
+        if (find(name, s)) continue;
+        const long long id = newCorrelationId();
+        opening.emplace(id, name);
+        session.openServiceAsync(name.c_str(), bbg::CorrelationId(id));
+    }
+    std::vector<std::string> failed;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+    while (!opening.empty()) {
+        const long long left = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (left <= 0) break;
+        bbg::Event event = session.nextEvent(static_cast<int>(left));
+        if (event.eventType() != bbg::Event::SERVICE_STATUS) continue;
+        bbg::MessageIterator msgIter(event);
+        while (msgIter.next()) {
+            bbg::Message msg = msgIter.message();
+            auto it = opening.find(msg.correlationId().asInteger());
+            if (it == opening.end()) continue;
+            if (msg.messageType() == SERVICE_OPENED) {
+                add(it->second, session.getService(it->second.c_str()));
+            } else if (msg.messageType() == SERVICE_OPEN_FAILURE) {
+                failed.push_back(it->second);
+            } else {
+                continue;
+            }
+            opening.erase(it);
+        }
+    }
+    for (const auto& o : opening) failed.push_back(o.second);
+    return failed;
+}
+
+SessionContext* sessionContext(SEXP con_) {
+    if (TYPEOF(con_) != EXTPTRSXP) return nullptr;
+    SEXP context_ = R_ExternalPtrProtected(con_);
+    if (TYPEOF(context_) != EXTPTRSXP || R_ExternalPtrTag(context_) == R_NilValue) return nullptr;
+    if (std::strcmp(CHAR(PRINTNAME(R_ExternalPtrTag(context_))), "Rblpapi::SessionContext*") != 0) return nullptr;
+    return reinterpret_cast<SessionContext*>(checkExternalPointer(context_, "Rblpapi::SessionContext*"));
+}
+
+void attachSessionContext(SEXP con_, SessionContext* context) {
+    SEXP context_ = Rcpp::Shield<SEXP>(createExternalPointer<SessionContext>(context, contextFinalizer,
+                                                                             "Rblpapi::SessionContext*"));
+    R_SetExternalPtrProtected(con_, context_);
+}
+
+#endif
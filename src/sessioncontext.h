@@ -0,0 +1,65 @@
+// -*- mode: C++; c-indent-level: 4; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+//
+//  sessioncontext.h -- services kept open for the life of a session
+//
+//  Copyright (C) 2026  Whit Armstrong and Dirk Eddelbuettel
+//
+//  This file is part of Rblpapi
+//
+//  Rblpapi is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  Rblpapi is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Rblpapi.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <blpapi_service.h>
+#include <blpapi_session.h>
+#include <Rcpp.h>
+#include <throttle.h>
+
+// What a connection keeps for the life of its session: the services opened
+// on it, so that only the first call on a service pays for openService() and
+// getService(), and the throttle adapting its requests to the server. Services can be opened ahead of any call, all at once, while
+// connecting. Service handles may be shared across threads, as may this.
+class SessionContext {
+public:
+    bool find(const std::string& name, BloombergLP::blpapi::Service& service) const;
+    void add(const std::string& name, const BloombergLP::blpapi::Service& service);
+    std::vector<std::string> services() const;
+    Throttle& throttle() { return throttle_; }
+
+    // R thread; the service, opened on a synchronous session first if need
+    // be, throws std::runtime_error
+    BloombergLP::blpapi::Service open(BloombergLP::blpapi::Session& session, const std::string& name);
+
+    // R thread; open services with openServiceAsync() on a synchronous
+    // session no one else uses meanwhile, pumping its events for up to
+    // 'timeout' milliseconds. Returns those not opened, which are tried
+    // again when first used.
+    std::vector<std::string> warmUp(BloombergLP::blpapi::Session& session,
+                                    const std::vector<std::string>& names, int timeout);
+
+private:
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, BloombergLP::blpapi::Service> services_;
+    Throttle throttle_;
+};
+
+// the context stored with a synchronous connection object, or nullptr
+SessionContext* sessionContext(SEXP con_);
+// store a context with a connection object, which owns it from then on
+void attachSessionContext(SEXP con_, SessionContext* context);
@@ -22,7 +22,9 @@
 #if defined(HaveBlp)
 
 // compare to SimpleSubscriptionExample.cpp
+#include <algorithm>
 #include <iostream>
+#include <limits>
 #include <vector>
 #include <map>
 #include <string>
@@ -35,6 +37,8 @@
 #include <blpapi_session.h>
 #include <blpapi_subscriptionlist.h>
 #include <blpapi_utils.h>
+#include <sessioncontext.h>
+#include <subscription.h>
 
 using BloombergLP::blpapi::Session;
 using BloombergLP::blpapi::Service;
@@ -46,6 +50,7 @@ using BloombergLP::blpapi::Element;
 using BloombergLP::blpapi::Message;
 using BloombergLP::blpapi::MessageIterator;
 using BloombergLP::blpapi::DatetimeParts;
+using BloombergLP::blpapi::Name;
 
 const std::map<Event::EventType,std::string> BlpapiEventToString { {Event::ADMIN,"ADMIN"},{Event::SESSION_STATUS,"SESSION_STATUS"},{Event::SUBSCRIPTION_STATUS,"SUBSCRIPTION_STATUS"},{Event::REQUEST_STATUS,"REQUEST_STATUS"},{Event::RESPONSE,"RESPONSE"},{Event::PARTIAL_RESPONSE,"PARTIAL_RESPONSE"},{Event::SUBSCRIPTION_DATA,"SUBSCRIPTION_DATA"},{Event::SERVICE_STATUS,"SERVICE_STATUS"},{Event::TIMEOUT,"TIMEOUT"},{Event::AUTHORIZATION_STATUS,"AUTHORIZATION_STATUS"},{Event::RESOLUTION_STATUS,"RESOLUTION_STATUS"},{Event::TOPIC_STATUS,"TOPIC_STATUS"},{Event::TOKEN_STATUS,"TOKEN_STATUS"},{Event::REQUEST,"REQUEST"},{Event::UNKNOWN,"UNKNOWN"} };
 
@@ -168,14 +173,19 @@ SEXP recursiveParse(const Element& e) {
 
 // [[Rcpp::export]]
 SEXP subscribe_Impl(SEXP con_, std::vector<std::string> securities, std::vector<std::string> fields,
-                    Rcpp::Function fun, SEXP options_, SEXP identity_) {
+                    Rcpp::Function fun, SEXP options_, SEXP identity_,
+                    int batchSize=0, int batchInterval=0, bool keepUnknown=false, int conflate=0,
+                    SEXP changes_=R_NilValue, SEXP tolerance_=R_NilValue) {
 #if defined(HaveBlp)
     // via Rcpp Attributes we get a try/catch block with error propagation to R "for free"
     Session* session =
         reinterpret_cast<Session*>(checkExternalPointer(con_, "blpapi::Session*"));
 
     const std::string mdsrv = "//blp/mktdata";
-    if (!session->openService(mdsrv.c_str())) {
+    SessionContext* context = sessionContext(con_);
+    if (context != nullptr) {
+        context->open(*session, mdsrv);
+    } else if (!session->openService(mdsrv.c_str())) {
         Rcpp::stop("Failed to open " + mdsrv);
     }
 
@@ -202,8 +212,88 @@ SEXP subscribe_Impl(SEXP con_, std::vector<std::string> securities, std::vector<
         session->subscribe(subscriptions);
     }
 
+    // batched mode: updates are staged in typed columns and 'fun' is called with a
+    // data.frame every 'batchSize' updates and/or every 'batchInterval' milliseconds;
+    // conflation implies batching, by default with batches at the conflation interval
+    if (conflate > 0 && batchSize <= 0 && batchInterval <= 0) {
+        batchInterval = conflate;
+    }
+    const bool batched = batchSize > 0 || batchInterval > 0;
+    // with a change filter, updates leaving all trigger fields as last delivered are dropped
+    std::vector<int> triggers;
+    std::vector<double> tolerances;
+    const bool changeOnly = changeFilterFromR(changes_, tolerance_, fields, triggers, tolerances);
+    LastValueCache lvc(conflate > 0 || changeOnly ? securities.size() : 0, conflate / 1000.0);
+    if (changeOnly) {
+        lvc.filterChanges(triggers, tolerances);
+    }
+    std::vector<Update> held;
+    UpdateDecoder decoder(fields, keepUnknown);
+    if (batched || changeOnly) {
+        decoder.compile(session->getService(mdsrv.c_str()));
+    }
+    UpdateBuffer buffer(fields.size(), batchSize > 0 ? batchSize : 1024);
+    Update update;
+    double nextFlush = currentTime() + batchInterval / 1000.0;
+    auto flush = [&]() {
+        if (buffer.size()) {
+            Rcpp::List df = updatesToDataFrame(buffer, securities, decoder.names());
+            buffer.clear();
+            fun(df);
+        }
+        nextFlush = currentTime() + batchInterval / 1000.0;
+    };
+    auto append = [&](const Update& u) {
+        buffer.append(u);
+        if (batchSize > 0 && buffer.size() >= static_cast<size_t>(batchSize)) flush();
+    };
+
     try {
         while (true) {
+            if (batched) {
+                int timeout = 0;        // zero waits indefinitely
+                if (batchInterval > 0) {
+                    timeout = std::max(1, static_cast<int>((nextFlush - currentTime()) * 1000.0));
+                }
+                if (conflate > 0 && (timeout == 0 || timeout > conflate)) {
+                    timeout = conflate;     // wake up to release held back updates
+                }
+                Event event = timeout > 0 ? session->nextEvent(timeout) : session->nextEvent();
+                Rcpp::checkUserInterrupt();
+                if (event.eventType() == Event::SUBSCRIPTION_DATA ||
+                    event.eventType() == Event::SUBSCRIPTION_STATUS) {
+                    MessageIterator msgIter(event);
+                    while (msgIter.next()) {
+                        Message msg = msgIter.message();
+                        size_t cid(msg.correlationId().asInteger());
+                        if (cid >= securities.size()) continue;
+                        if (event.eventType() == Event::SUBSCRIPTION_STATUS) {
+                            // the data.frame has no room for status messages, so report failures
+                            if (msg.messageType() == Name("SubscriptionFailure") ||
+                                msg.messageType() == Name("SubscriptionTerminated")) {
+                                Rcpp::Rcerr << msg.messageType().string() << " for " << securities[cid] << std::endl;
+                            }
+                        } else if (decoder.decode(msg, static_cast<int>(cid), update)) {
+                            if (!lvc.conflating() && !lvc.filtering()) {
+                                append(update);
+                            } else if (lvc.update(update)) {
+                                if (lvc.conflating()) lvc.row(update.topic, update);
+                                append(update);
+                            }
+                        }
+                    }
+                }
+                if (lvc.conflating()) {
+                    lvc.collectDue(currentTime(), held);
+                    for (const auto& h : held) {
+                        append(h);
+                    }
+                    held.clear();
+                }
+                if (batchInterval > 0 && currentTime() >= nextFlush) flush();
+                continue;
+            }
+
             Event event = session->nextEvent();
             Rcpp::checkUserInterrupt();
             MessageIterator msgIter(event);
@@ -219,6 +309,12 @@ SEXP subscribe_Impl(SEXP con_, std::vector<std::string> securities, std::vector<
                     }
                     ans["event.type"] = it->second;
                     size_t cid(msg.correlationId().asInteger());
+                    if (changeOnly && event.eventType() == Event::SUBSCRIPTION_DATA &&
+                        (cid >= securities.size() ||
+                         !decoder.decode(msg, static_cast<int>(cid), update) ||
+                         !lvc.update(update))) {
+                        continue;       // nothing the caller asked to hear about changed
+                    }
                     if(cid >= 0 && cid < securities.size()) {
                         ans["topic"] = securities[cid];
                     }
@@ -230,6 +326,15 @@ SEXP subscribe_Impl(SEXP con_, std::vector<std::string> securities, std::vector<
         }
     } catch (const Rcpp::internal::InterruptedException& e) {
         session->unsubscribe(subscriptions);
+        // the last, partial batch is delivered rather than dropped
+        if (batched) {
+            if (lvc.conflating()) {
+                lvc.collectDue(std::numeric_limits<double>::infinity(), held);
+                for (const auto& h : held) buffer.append(h);
+                held.clear();
+            }
+            flush();
+        }
     }
     return R_NilValue;
 #else // ie no Blp
@@ -0,0 +1,675 @@
+// -*- mode: C++; c-indent-level: 4; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+//
+//  subscription.cpp -- decoded subscription updates and columnar staging
+//
+//  Copyright (C) 2026  Whit Armstrong and Dirk Eddelbuettel
+//
+//  This file is part of Rblpapi
+//
+//  Rblpapi is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  Rblpapi is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Rblpapi.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <subscription.h>
+
+namespace {
+    bool numericKind(FieldValue::Kind k) {
+        return k == FieldValue::Logical || k == FieldValue::Integer || k == FieldValue::Double;
+    }
+
+    // text of a non-string value, for columns that had to become strings
+    std::string valueToString(FieldValue::Kind kind, double num) {
+        char txt[48];
+        switch (kind) {
+        case FieldValue::Logical:
+            return num != 0.0 ? "TRUE" : "FALSE";
+        case FieldValue::Date:
+        case FieldValue::Datetime: {
+            const double secs = kind == FieldValue::Date ? num * 86400.0 : num;
+            const long long days = static_cast<long long>(std::floor(secs / 86400.0));
+            // see http://howardhinnant.github.io/date_algorithms.html
+            const long long z = days + 719468;
+            const long long era = (z >= 0 ? z : z - 146096) / 146097;
+            const unsigned doe = static_cast<unsigned>(z - era * 146097);
+            const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+            const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+            const unsigned mp = (5 * doy + 2) / 153;
+            const unsigned d = doy - (153 * mp + 2) / 5 + 1;
+            const unsigned m = mp < 10 ? mp + 3 : mp - 9;
+            const long long y = static_cast<long long>(yoe) + era * 400 + (m <= 2);
+            if (kind == FieldValue::Date) {
+                snprintf(txt, sizeof(txt), "%04lld-%02u-%02u", y, m, d);
+            } else {
+                const double t = secs - days * 86400.0;
+                const int h = static_cast<int>(t / 3600), mi = static_cast<int>(t / 60) % 60;
+                snprintf(txt, sizeof(txt), "%04lld-%02u-%02u %02d:%02d:%06.3f", y, m, d, h, mi,
+                         t - h * 3600 - mi * 60);
+            }
+            return txt;
+        }
+        default:
+            snprintf(txt, sizeof(txt), "%.15g", num);
+            return txt;
+        }
+    }
+}
+
+void Column::append(const FieldValue& v, size_t nrow) {
+    if (kind == FieldValue::Null) {
+        if (v.isNull()) return;             // nothing stored until the type is known
+        kind = v.kind;
+        if (kind == FieldValue::String) {
+            str.assign(nrow, std::string());
+            missing.assign(nrow, 1);
+        } else {
+            num.assign(nrow, NA_REAL);
+        }
+    }
+    if (!v.isNull() && v.kind != kind && kind != FieldValue::String) {
+        widen(v.kind);
+    }
+    if (kind == FieldValue::String) {
+        if (v.isNull()) {
+            str.emplace_back();
+            missing.push_back(1);
+        } else if (v.kind == FieldValue::String) {
+            str.push_back(v.str);
+            missing.push_back(0);
+        } else {
+            str.push_back(valueToString(v.kind, v.num));
+            missing.push_back(0);
+        }
+    } else {
+        num.push_back(v.isNull() ? NA_REAL : v.num);
+    }
+}
+
+void Column::widen(FieldValue::Kind other) {
+    if (numericKind(kind) && numericKind(other)) {
+        kind = std::max(kind, other);       // logical, integer, double in this order
+        return;
+    }
+    // any other mix only fits into strings
+    str.clear();
+    missing.clear();
+    str.reserve(num.capacity());
+    missing.reserve(num.capacity());
+    for (double x : num) {
+        const bool na = ISNA(x);
+        str.push_back(na ? std::string() : valueToString(kind, x));
+        missing.push_back(na);
+    }
+    num.clear();
+    kind = FieldValue::String;
+}
+
+void Column::reserve(size_t n) {
+    if (kind == FieldValue::String) {
+        str.reserve(n);
+        missing.reserve(n);
+    } else {
+        num.reserve(n);
+    }
+}
+
+void Column::clear() {
+    // the type is kept so that later batches come out with the same column types
+    num.clear();
+    str.clear();
+    missing.clear();
+}
+
+UpdateBuffer::UpdateBuffer(size_t nfields, size_t capacity) : columns(nfields), capacity(capacity) {
+    topic.reserve(capacity);
+    received.reserve(capacity);
+}
+
+void UpdateBuffer::append(const Update& u) {
+    const size_t nrow = size();
+    while (columns.size() < u.values.size()) {
+        addField();                         // a decoder keeping unknown elements has grown
+    }
+    for (size_t j = 0; j < columns.size(); ++j) {
+        Column& col = columns[j];
+        bool wasNull = col.kind == FieldValue::Null;
+        col.append(j < u.values.size() ? u.values[j] : FieldValue(), nrow);
+        if (wasNull && col.kind != FieldValue::Null) col.reserve(capacity);
+    }
+    topic.push_back(u.topic);
+    received.push_back(u.received);
+}
+
+void UpdateBuffer::addField() {
+    columns.emplace_back();
+}
+
+void UpdateBuffer::clear() {
+    topic.clear();
+    received.clear();
+    for (auto& col : columns) {
+        col.clear();
+        if (col.kind == FieldValue::String) {
+            col.str.reserve(capacity);
+            col.missing.reserve(capacity);
+        }
+    }
+}
+
+LastValueCache::LastValueCache(size_t ntopics, double interval) : interval(interval) {
+    resize(ntopics);
+}
+
+void LastValueCache::resize(size_t ntopics) {
+    rows.resize(ntopics, Row{std::vector<FieldValue>(), std::numeric_limits<double>::quiet_NaN()});
+}
+
+void LastValueCache::filterChanges(const std::vector<int>& t, const std::vector<double>& tol) {
+    filter = true;
+    triggers = t;
+    tolerance = tol;
+}
+
+bool LastValueCache::changed(const Row& r, size_t slot, const FieldValue& v) const {
+    if (v.isNull()) return false;
+    if (slot >= r.sent.size() || r.sent[slot].isNull()) return true;
+    const FieldValue& old = r.sent[slot];
+    if (v.kind == FieldValue::String || old.kind == FieldValue::String) {
+        return v.kind != old.kind || v.str != old.str;
+    }
+    const double tol = slot < tolerance.size() ? tolerance[slot] : 0.0;
+    return tol > 0.0 ? std::fabs(v.num - old.num) > tol : v.num != old.num;
+}
+
+bool LastValueCache::changed(const Row& r, const Update& u) const {
+    if (triggers.empty()) {
+        for (size_t j = 0; j < u.values.size(); ++j) {
+            if (changed(r, j, u.values[j])) return true;
+        }
+        return false;
+    }
+    for (int j : triggers) {
+        if (static_cast<size_t>(j) < u.values.size() && changed(r, j, u.values[j])) return true;
+    }
+    return false;
+}
+
+void LastValueCache::markSent(Row& r) {
+    if (filter) r.sent = r.values;
+}
+
+bool LastValueCache::update(const Update& u) {
+    if (u.topic < 0 || static_cast<size_t>(u.topic) >= rows.size()) return false;
+    Row& r = rows[u.topic];
+    // an unchanged update is still merged, it just does not wake anyone up;
+    // a conflated row already held goes out with its interval regardless
+    const bool pass = !filter || changed(r, u);
+    if (r.values.size() < u.values.size()) r.values.resize(u.values.size());
+    for (size_t j = 0; j < u.values.size(); ++j) {
+        if (!u.values[j].isNull()) r.values[j] = u.values[j];
+    }
+    r.time = u.received;
+    if (!pass) return false;
+    if (!conflating()) {
+        markSent(r);
+        return true;
+    }
+    if (u.received >= r.nextEmit) {
+        r.nextEmit = u.received + interval;
+        r.held = false;
+        markSent(r);
+        return true;
+    }
+    r.held = true;
+    return false;
+}
+
+void LastValueCache::row(int topic, Update& out) const {
+    const Row& r = rows[topic];
+    out.topic = topic;
+    out.received = r.time;
+    out.values = r.values;
+}
+
+void LastValueCache::collectDue(double now, std::vector<Update>& out) {
+    for (size_t i = 0; i < rows.size(); ++i) {
+        Row& r = rows[i];
+        if (r.held && now >= r.nextEmit) {
+            out.emplace_back();
+            row(static_cast<int>(i), out.back());
+            r.nextEmit = now + interval;
+            r.held = false;
+            markSent(r);
+        }
+    }
+}
+
+void LastValueCache::snapshot(UpdateBuffer& buffer) const {
+    Update u;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        row(static_cast<int>(i), u);
+        buffer.append(u);
+    }
+}
+
+UpdateRing::UpdateRing(size_t capacity)
+    : capacity(std::max<size_t>(capacity, 1)), received(this->capacity) {
+}
+
+size_t UpdateRing::rowBytes(size_t nfields) {
+    return sizeof(double) + nfields * (sizeof(double) + sizeof(uint8_t));
+}
+
+void UpdateRing::append(const Update& u) {
+    topic = u.topic;
+    while (columns.size() < u.values.size()) {
+        columns.emplace_back();
+        columns.back().kind.assign(capacity, FieldValue::Null);
+        columns.back().num.assign(capacity, 0.0);
+    }
+    received[head] = u.received;
+    for (size_t j = 0; j < columns.size(); ++j) {
+        RingColumn& col = columns[j];
+        const FieldValue& v = j < u.values.size() ? u.values[j] : FieldValue();
+        col.kind[head] = v.kind;
+        if (v.kind == FieldValue::String) {
+            if (col.str.empty()) col.str.resize(capacity);
+            col.str[head].assign(v.str);
+        } else {
+            col.num[head] = v.num;
+        }
+    }
+    head = (head + 1) % capacity;
+    if (count < capacity) ++count;
+}
+
+void UpdateRing::window(size_t n, double since, std::vector<Update>& out) const {
+    if (n == 0 || n > count) n = count;
+    const size_t first = (head + capacity - n) % capacity;
+    for (size_t k = 0; k < n; ++k) {
+        const size_t i = (first + k) % capacity;
+        if (received[i] < since) continue;  // rows are in receive order
+        out.emplace_back();
+        Update& u = out.back();
+        u.topic = topic;
+        u.received = received[i];
+        u.values.resize(columns.size());
+        for (size_t j = 0; j < columns.size(); ++j) {
+            const RingColumn& col = columns[j];
+            FieldValue& v = u.values[j];
+            v.kind = static_cast<FieldValue::Kind>(col.kind[i]);
+            if (v.kind == FieldValue::String) {
+                v.str = col.str[i];
+            } else {
+                v.num = col.num[i];
+            }
+        }
+    }
+}
+
+double currentTime() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(system_clock::now().time_since_epoch()).count() * 1.0e-6;
+}
+
+// see http://howardhinnant.github.io/date_algorithms.html
+int daysFromCivil(int y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int>(doe) - 719468;
+}
+
+#if defined(HaveBlp)
+#include <blpapi_defs.h>
+#include <blpapi_datetime.h>
+#include <blpapi_schema.h>
+#include <blpapi_utils.h>
+
+using BloombergLP::blpapi::Element;
+using BloombergLP::blpapi::Message;
+using BloombergLP::blpapi::Name;
+using BloombergLP::blpapi::Service;
+using BloombergLP::blpapi::SchemaTypeDefinition;
+using BloombergLP::blpapi::Datetime;
+using BloombergLP::blpapi::DatetimeParts;
+
+FieldValue elementToFieldValue(const Element& e) {
+    FieldValue v;
+    if (e.isNull() || e.numValues() == 0) return v;
+    switch (e.datatype()) {
+    case BLPAPI_DATATYPE_BOOL:
+        v.kind = FieldValue::Logical;
+        v.num = e.getValueAsBool() ? 1.0 : 0.0;
+        break;
+    case BLPAPI_DATATYPE_INT32:
+        v.kind = FieldValue::Integer;
+        v.num = e.getValueAsInt32();
+        break;
+    case BLPAPI_DATATYPE_INT64:             // may exceed an R integer
+    case BLPAPI_DATATYPE_FLOAT32:
+    case BLPAPI_DATATYPE_FLOAT64:
+    case BLPAPI_DATATYPE_DECIMAL:
+        v.kind = FieldValue::Double;
+        v.num = e.getValueAsFloat64();
+        break;
+    case BLPAPI_DATATYPE_DATE: {
+        Datetime dt = e.getValueAsDatetime();
+        v.kind = FieldValue::Date;
+        v.num = daysFromCivil(dt.year(), dt.month(), dt.day());
+        break;
+    }
+    case BLPAPI_DATATYPE_DATETIME: {
+        Datetime dt = e.getValueAsDatetime();
+        // as in subscribe.cpp, timestamps without a date are returned as strings
+        if (dt.hasParts(DatetimeParts::DATE)) {
+            v.kind = FieldValue::Datetime;
+            v.num = daysFromCivil(dt.year(), dt.month(), dt.day()) * 86400.0;
+            if (dt.hasParts(DatetimeParts::TIME)) {
+                v.num += dt.hours() * 3600.0 + dt.minutes() * 60.0 + dt.seconds();
+            }
+            if (dt.hasParts(DatetimeParts::MILLISECONDS)) {
+                v.num += dt.milliseconds() / 1000.0;
+            }
+        } else {
+            v.kind = FieldValue::String;
+            v.str = e.getValueAsString();
+        }
+        break;
+    }
+    case BLPAPI_DATATYPE_CHAR:
+    case BLPAPI_DATATYPE_STRING:
+    case BLPAPI_DATATYPE_TIME:
+    case BLPAPI_DATATYPE_ENUMERATION:
+        v.kind = FieldValue::String;
+        v.str = e.getValueAsString();
+        break;
+    default:                                // byte arrays, sequences, choices
+        break;
+    }
+    return v;
+}
+
+UpdateDecoder::UpdateDecoder(const std::vector<std::string>& fields, bool keepUnknown)
+    : keepUnknown(keepUnknown) {
+    for (const auto& f : fields) {
+        addSlot(Name(f.c_str()), FieldValue::Null);
+    }
+}
+
+size_t UpdateDecoder::addSlot(const Name& name, FieldValue::Kind kind) {
+    auto it = index.find(name);
+    if (it != index.end()) return it->second;  // field requested twice
+    slots.push_back(Slot{name, kind});
+    index.emplace(name, slots.size() - 1);
+    std::lock_guard<std::mutex> lock(namesMutex);
+    names_.push_back(name.string());
+    return slots.size() - 1;
+}
+
+namespace {
+    FieldValue::Kind schemaKind(const SchemaTypeDefinition& events, const Name& name) {
+        if (!events.hasElementDefinition(name)) return FieldValue::Null;
+        switch (events.getElementDefinition(name).typeDefinition().datatype()) {
+        case BLPAPI_DATATYPE_BOOL:
+            return FieldValue::Logical;
+        case BLPAPI_DATATYPE_INT32:
+            return FieldValue::Integer;
+        case BLPAPI_DATATYPE_INT64:
+        case BLPAPI_DATATYPE_FLOAT32:
+        case BLPAPI_DATATYPE_FLOAT64:
+        case BLPAPI_DATATYPE_DECIMAL:
+            return FieldValue::Double;
+        case BLPAPI_DATATYPE_DATE:
+            return FieldValue::Date;
+        case BLPAPI_DATATYPE_CHAR:
+        case BLPAPI_DATATYPE_STRING:
+        case BLPAPI_DATATYPE_TIME:
+        case BLPAPI_DATATYPE_ENUMERATION:
+            return FieldValue::String;
+        default:                            // datetimes may or may not carry a date
+            return FieldValue::Null;
+        }
+    }
+
+    const Name MARKET_DATA_EVENTS("MarketDataEvents");
+}
+
+void UpdateDecoder::compile(const Service& service) {
+    if (!service.hasEventDefinition(MARKET_DATA_EVENTS)) return;
+    schema = service;
+    compiled = true;
+    SchemaTypeDefinition events = service.getEventDefinition(MARKET_DATA_EVENTS).typeDefinition();
+    for (auto& slot : slots) {
+        slot.kind = schemaKind(events, slot.name);
+    }
+}
+
+size_t UpdateDecoder::addField(const std::string& field) {
+    const Name name(field.c_str());
+    FieldValue::Kind kind = FieldValue::Null;
+    if (compiled) {
+        kind = schemaKind(schema.getEventDefinition(MARKET_DATA_EVENTS).typeDefinition(), name);
+    }
+    return addSlot(name, kind);
+}
+
+bool UpdateDecoder::decode(const Message& msg, int topic, Update& u) {
+    Element e = msg.asElement();
+    u.topic = topic;
+    u.received = currentTime();
+    u.values.assign(slots.size(), FieldValue());
+    bool found = false;
+    const size_t n = e.numElements();
+    for (size_t i = 0; i < n; ++i) {
+        Element c = e.getElement(i);
+        if (c.isNull() || c.numValues() == 0) continue;
+        auto it = index.find(c.name());
+        size_t j;
+        if (it != index.end()) {
+            j = it->second;
+        } else if (keepUnknown && !c.isComplexType()) {
+            j = addSlot(c.name(), FieldValue::Null);
+            u.values.resize(slots.size());
+        } else {
+            continue;
+        }
+        FieldValue& v = u.values[j];
+        switch (slots[j].kind) {
+        case FieldValue::Logical:
+            v.kind = FieldValue::Logical;
+            v.num = c.getValueAsBool() ? 1.0 : 0.0;
+            break;
+        case FieldValue::Integer:
+            v.kind = FieldValue::Integer;
+            v.num = c.getValueAsInt32();
+            break;
+        case FieldValue::Double:
+            v.kind = FieldValue::Double;
+            v.num = c.getValueAsFloat64();
+            break;
+        case FieldValue::String:
+            v.kind = FieldValue::String;
+            v.str = c.getValueAsString();
+            break;
+        default:
+            v = elementToFieldValue(c);
+            break;
+        }
+        found = found || !v.isNull();
+    }
+    return found;
+}
+
+std::vector<std::string> UpdateDecoder::names() const {
+    std::lock_guard<std::mutex> lock(namesMutex);
+    return names_;
+}
+#endif
+
+Rcpp::NumericVector createPOSIXtVector(const std::vector<double> & ticks,
+                                       const std::string tz) {
+    Rcpp::NumericVector pt(ticks.begin(), ticks.end());
+    pt.attr("class") = Rcpp::CharacterVector::create("POSIXct", "POSIXt");
+    pt.attr("tzone") = tz;
+    return pt;
+}
+
+SEXP columnToR(const Column& col, size_t n) {
+    switch (col.kind) {
+    case FieldValue::Null:
+        return Rcpp::LogicalVector(n, NA_LOGICAL);
+    case FieldValue::Logical: {
+        Rcpp::LogicalVector ans(n);
+        for (size_t i = 0; i < n; ++i) {
+            ans[i] = ISNA(col.num[i]) ? NA_LOGICAL : static_cast<int>(col.num[i] != 0.0);
+        }
+        return ans;
+    }
+    case FieldValue::Integer: {
+        Rcpp::IntegerVector ans(n);
+        for (size_t i = 0; i < n; ++i) {
+            ans[i] = ISNA(col.num[i]) ? NA_INTEGER : static_cast<int>(col.num[i]);
+        }
+        return ans;
+    }
+    case FieldValue::String: {
+        Rcpp::CharacterVector ans(n);
+        for (size_t i = 0; i < n; ++i) {
+            if (col.missing[i]) {
+                ans[i] = NA_STRING;
+            } else {
+                ans[i] = col.str[i];
+            }
+        }
+        return ans;
+    }
+    case FieldValue::Date: {
+        Rcpp::NumericVector ans(col.num.begin(), col.num.begin() + n);
+        ans.attr("class") = "Date";
+        return ans;
+    }
+    case FieldValue::Datetime:
+        return createPOSIXtVector(std::vector<double>(col.num.begin(), col.num.begin() + n));
+    default:
+        return Rcpp::NumericVector(col.num.begin(), col.num.begin() + n);
+    }
+}
+
+SEXP fieldValueToR(const FieldValue& v) {
+    switch (v.kind) {
+    case FieldValue::Logical:
+        return Rcpp::LogicalVector::create(v.num != 0.0);
+    case FieldValue::Integer:
+        return Rcpp::IntegerVector::create(static_cast<int>(v.num));
+    case FieldValue::Double:
+        return Rcpp::NumericVector::create(v.num);
+    case FieldValue::String:
+        return Rcpp::CharacterVector::create(v.str);
+    case FieldValue::Date: {
+        Rcpp::NumericVector ans = Rcpp::NumericVector::create(v.num);
+        ans.attr("class") = "Date";
+        return ans;
+    }
+    case FieldValue::Datetime:
+        return createPOSIXtVector(std::vector<double>(1, v.num));
+    default:
+        return R_NilValue;
+    }
+}
+
+Rcpp::List updateToList(const Update& u, const std::vector<std::string>& fields) {
+    std::vector<size_t> present;
+    for (size_t j = 0; j < u.values.size(); ++j) {
+        if (!u.values[j].isNull()) present.push_back(j);
+    }
+    Rcpp::List ans(present.size());
+    Rcpp::CharacterVector names(present.size());
+    for (size_t i = 0; i < present.size(); ++i) {
+        const size_t j = present[i];
+        ans[i] = fieldValueToR(u.values[j]);
+        names[i] = j < fields.size() ? fields[j] : std::string("V") + std::to_string(j + 1);
+    }
+    ans.attr("names") = names;
+    return ans;
+}
+
+bool changeFilterFromR(SEXP changes, SEXP tolerance, const std::vector<std::string>& fields,
+                       std::vector<int>& triggers, std::vector<double>& tolerances) {
+    triggers.clear();
+    tolerances.clear();
+    if (Rf_isNull(changes) || (TYPEOF(changes) == LGLSXP && !Rcpp::as<bool>(changes))) {
+        // a tolerance on its own would silently filter nothing
+        if (!Rf_isNull(tolerance)) Rcpp::stop("Tolerance requires changes.");
+        return false;
+    }
+    auto slot = [&](const std::string& f) {
+        auto it = std::find(fields.begin(), fields.end(), f);
+        if (it == fields.end()) {
+            Rcpp::stop("Field '" + f + "' is not subscribed.");
+        }
+        return static_cast<int>(it - fields.begin());
+    };
+    if (TYPEOF(changes) != LGLSXP) {
+        for (const auto& f : Rcpp::as<std::vector<std::string>>(changes)) {
+            triggers.push_back(slot(f));
+        }
+    }
+    if (!Rf_isNull(tolerance)) {
+        Rcpp::NumericVector tol(tolerance);
+        Rcpp::CharacterVector names = tol.names();
+        if (names.size() != tol.size()) {
+            Rcpp::stop("Tolerances need to be named by field.");
+        }
+        tolerances.assign(fields.size(), 0.0);
+        for (R_xlen_t i = 0; i < tol.size(); ++i) {
+            tolerances[slot(Rcpp::as<std::string>(names[i]))] = tol[i];
+        }
+    }
+    return true;
+}
+
+Rcpp::List updatesToDataFrame(const UpdateBuffer& buffer,
+                              const std::vector<std::string>& topics,
+                              const std::vector<std::string>& fields) {
+    const size_t n = buffer.size();
+    const size_t nf = buffer.numFields();
+    Rcpp::List ans(2 + nf);
+    Rcpp::CharacterVector names(2 + nf);
+
+    // topics as a factor over the subscribed securities, correlation ids are zero-based
+    Rcpp::IntegerVector topic(n);
+    for (size_t i = 0; i < n; ++i) {
+        topic[i] = buffer.topic[i] + 1;
+    }
+    topic.attr("levels") = Rcpp::wrap(topics);
+    topic.attr("class") = "factor";
+    ans[0] = topic;
+    names[0] = "topic";
+    ans[1] = createPOSIXtVector(buffer.received);
+    names[1] = "time";
+
+    for (size_t j = 0; j < nf; ++j) {
+        ans[j + 2] = columnToR(buffer.columns[j], n);
+        names[j + 2] = j < fields.size() ? fields[j] : std::string("V") + std::to_string(j + 1);
+    }
+    ans.attr("names") = names;
+    ans.attr("class") = "data.frame";
+    ans.attr("row.names") = Rcpp::IntegerVector::create(NA_INTEGER, -static_cast<int>(n));
+    return ans;
+}
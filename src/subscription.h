@@ -0,0 +1,242 @@
+// -*- mode: C++; c-indent-level: 4; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+//
+//  subscription.h -- decoded subscription updates and columnar staging
+//
+//  Copyright (C) 2026  Whit Armstrong and Dirk Eddelbuettel
+//
+//  This file is part of Rblpapi
+//
+//  Rblpapi is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  Rblpapi is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Rblpapi.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Everything in here is free of R objects so that updates can be decoded and
+// staged away from the R thread; only the conversion to R (declared at the
+// bottom) has to happen on the main thread.
+
+// typed value of a single field in a single update
+struct FieldValue {
+    enum Kind : uint8_t { Null = 0, Logical, Integer, Double, String, Date, Datetime };
+
+    Kind kind = Null;
+    double num = 0.0;           // all but strings; dates as days, datetimes as seconds since epoch
+    std::string str;
+
+    bool isNull() const { return kind == Null; }
+};
+
+// one decoded SUBSCRIPTION_DATA message
+struct Update {
+    int topic = -1;                     // index of the subscribed security, also its correlation id
+    double received = 0.0;              // seconds since epoch
+    std::vector<FieldValue> values;     // one slot per field
+};
+
+// one typed column; the type is set by the first non-null value seen, and
+// widened when a later value is of another kind: to the wider of mixed
+// logical, integer and double, otherwise to string
+struct Column {
+    FieldValue::Kind kind = FieldValue::Null;
+    std::vector<double> num;
+    std::vector<std::string> str;
+    std::vector<uint8_t> missing;       // for string columns only
+
+    void append(const FieldValue& v, size_t nrow);
+    void widen(FieldValue::Kind other);
+    void reserve(size_t n);
+    void clear();
+};
+
+// updates staged in preallocated columns until they are handed to R in one go
+class UpdateBuffer {
+public:
+    UpdateBuffer(size_t nfields, size_t capacity);
+
+    void append(const Update& u);
+    void addField();                    // widen by one (initially all missing) column
+    size_t size() const { return topic.size(); }
+    size_t numFields() const { return columns.size(); }
+    void clear();
+
+    std::vector<int> topic;
+    std::vector<double> received;
+    std::vector<Column> columns;
+
+private:
+    size_t capacity;
+};
+
+// Latest value of every field of every topic, overwritten in place. With a
+// conflation interval at most one update per topic and interval is let
+// through, carrying all last values of the topic; updates held back are
+// released by collectDue() once their interval has passed. With a change
+// filter, updates that leave all trigger fields unchanged since the last
+// update passed on are merged but not passed on.
+class LastValueCache {
+public:
+    LastValueCache(size_t ntopics, double interval);   // interval in seconds, zero for none
+
+    // merge u, returns whether an update for u.topic should be passed on now
+    bool update(const Update& u);
+    // current last values of one topic, with the time of its last update
+    void row(int topic, Update& out) const;
+    // conflated updates whose interval has passed by 'now'
+    void collectDue(double now, std::vector<Update>& out);
+    // one row per topic, topics never updated have all values and the time missing
+    void snapshot(UpdateBuffer& buffer) const;
+
+    bool conflating() const { return interval > 0.0; }
+    void resize(size_t ntopics);
+
+    // pass on only updates changing one of the trigger slots, all slots if
+    // empty, by more than its tolerance (indexed by slot, zero if missing)
+    void filterChanges(const std::vector<int>& triggers, const std::vector<double>& tolerance);
+    bool filtering() const { return filter; }
+
+private:
+    struct Row {
+        std::vector<FieldValue> values;
+        double time;
+        double nextEmit = 0.0;
+        bool held = false;
+        std::vector<FieldValue> sent;   // trigger values last passed on
+    };
+    bool changed(const Row& r, const Update& u) const;
+    bool changed(const Row& r, size_t slot, const FieldValue& v) const;
+    void markSent(Row& r);
+
+    std::vector<Row> rows;
+    double interval;
+    bool filter = false;
+    std::vector<int> triggers;
+    std::vector<double> tolerance;
+};
+
+// Most recent updates of one topic in columns of fixed capacity, the oldest
+// row being overwritten once full, so that memory stays constant however long
+// the subscription runs. Cells keep their own kind; string cells reuse their
+// buffers as rows are overwritten.
+class UpdateRing {
+public:
+    explicit UpdateRing(size_t capacity);
+
+    void append(const Update& u);
+    // the last n (all if zero) rows received at or after 'since', oldest first
+    void window(size_t n, double since, std::vector<Update>& out) const;
+    size_t size() const { return count; }
+
+    // approximate bytes per row of nfields numeric fields, to size rings by memory
+    static size_t rowBytes(size_t nfields);
+
+private:
+    struct RingColumn {
+        std::vector<uint8_t> kind;
+        std::vector<double> num;
+        std::vector<std::string> str;   // allocated on the first string value
+    };
+
+    size_t capacity;
+    size_t head = 0;                    // next row to write
+    size_t count = 0;
+    int topic = -1;
+    std::vector<double> received;
+    std::vector<RingColumn> columns;
+};
+
+// wall clock in seconds since epoch
+double currentTime();
+
+// civil date to days since epoch, usable off the R thread
+int daysFromCivil(int y, unsigned m, unsigned d);
+
+#if defined(HaveBlp)
+#include <blpapi_element.h>
+#include <blpapi_message.h>
+#include <blpapi_name.h>
+#include <blpapi_service.h>
+#include <mutex>
+#include <unordered_map>
+
+// element to typed value, usable off the R thread
+FieldValue elementToFieldValue(const BloombergLP::blpapi::Element& e);
+
+// Decoder compiled once per subscription: every requested field is given a
+// slot typed from the //blp/mktdata schema, and a message is decoded in a
+// single pass over its elements straight into a flat Update. Elements not
+// requested are dropped unless keepUnknown is set, in which case they are
+// given (untyped) slots of their own as they are first seen.
+class UpdateDecoder {
+public:
+    UpdateDecoder(const std::vector<std::string>& fields, bool keepUnknown);
+
+    // type the slots from the MarketDataEvents definition of the service
+    void compile(const BloombergLP::blpapi::Service& service);
+
+    // slot of a field, added (and typed if compiled) when not decoded yet
+    size_t addField(const std::string& field);
+
+    // returns false if none of the slots was present in msg
+    bool decode(const BloombergLP::blpapi::Message& msg, int topic, Update& u);
+
+    // requested fields followed by any kept unknown elements; safe to call from any thread
+    std::vector<std::string> names() const;
+
+private:
+    struct Slot {
+        BloombergLP::blpapi::Name name;
+        FieldValue::Kind kind;          // Null when the type is only known per value
+    };
+    struct NameHash {
+        size_t operator()(const BloombergLP::blpapi::Name& n) const { return n.hash(); }
+    };
+
+    size_t addSlot(const BloombergLP::blpapi::Name& name, FieldValue::Kind kind);
+
+    std::vector<Slot> slots;
+    std::unordered_map<BloombergLP::blpapi::Name, size_t, NameHash> index;
+    bool keepUnknown;
+    BloombergLP::blpapi::Service schema;
+    bool compiled = false;
+
+    mutable std::mutex namesMutex;      // names grow on the decoding thread
+    std::vector<std::string> names_;
+};
+#endif
+
+// The conversions to R need no session either, so that journals can be
+// replayed in builds without blp.
+#include <Rcpp.h>
+
+Rcpp::NumericVector createPOSIXtVector(const std::vector<double> & ticks, const std::string tz="UTC");
+
+// single value as R scalar, NULL if missing
+SEXP fieldValueToR(const FieldValue& v);
+
+// named list of the non-missing values of one update
+Rcpp::List updateToList(const Update& u, const std::vector<std::string>& fields);
+
+// change filter from the R arguments 'changes' (NULL, a flag, or trigger field
+// names) and 'tolerance' (named numeric); false if no filter was asked for,
+// stops if a tolerance is given without one
+bool changeFilterFromR(SEXP changes, SEXP tolerance, const std::vector<std::string>& fields,
+                       std::vector<int>& triggers, std::vector<double>& tolerances);
+
+// materialise as data.frame with 'topic' (factor), 'time' (POSIXct) and one column per field
+Rcpp::List updatesToDataFrame(const UpdateBuffer& buffer,
+                              const std::vector<std::string>& topics,
+                              const std::vector<std::string>& fields);
@@ -0,0 +1,1061 @@
+// -*- mode: C++; c-indent-level: 4; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+//
+//  subscriptionengine.cpp -- market data subscriptions on a background thread
+//
+//  Copyright (C) 2026  Whit Armstrong and Dirk Eddelbuettel
+//
+//  This file is part of Rblpapi
+//
+//  Rblpapi is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  Rblpapi is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Rblpapi.  If not, see <http://www.gnu.org/licenses/>.
+
+#if defined(HaveBlp)
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <blpapi_correlationid.h>
+#include <blpapi_element.h>
+#include <blpapi_exception.h>
+#include <blpapi_message.h>
+#include <blpapi_utils.h>
+#include <finalizers.h>
+#include <subscriptionengine.h>
+
+namespace bbg = BloombergLP::blpapi;
+
+namespace {
+    const bbg::Name SESSION_STARTED("SessionStarted");
+    const bbg::Name SESSION_STARTUP_FAILURE("SessionStartupFailure");
+    const bbg::Name SESSION_TERMINATED("SessionTerminated");
+    const bbg::Name SERVICE_OPENED("ServiceOpened");
+    const bbg::Name SERVICE_OPEN_FAILURE("ServiceOpenFailure");
+    const char* MKTDATA_SERVICE = "//blp/mktdata";
+    const char* MKTDEPTH_SERVICE = "//blp/mktdepthdata";
+    const bbg::Name SUBSCRIPTION_STARTED("SubscriptionStarted");
+    const bbg::Name SUBSCRIPTION_FAILURE("SubscriptionFailure");
+    const bbg::Name SUBSCRIPTION_TERMINATED("SubscriptionTerminated");
+    const bbg::Name REASON("reason");
+    const bbg::Name DESCRIPTION("description");
+    const bbg::Name MKTDATA_EVENT_TYPE("MKTDATA_EVENT_TYPE");
+    const bbg::Name MKTDATA_EVENT_SUBTYPE("MKTDATA_EVENT_SUBTYPE");
+
+    const char* stateNames[] = { "starting", "running", "stopped", "failed" };
+
+    std::string reasonOf(const bbg::Message& msg) {
+        bbg::Element e = msg.asElement();
+        if (e.hasElement(REASON) && e.getElement(REASON).hasElement(DESCRIPTION)) {
+            return e.getElement(REASON).getElementAsString(DESCRIPTION);
+        }
+        return std::string();
+    }
+}
+
+SubscriptionEngine::SubscriptionEngine(const std::vector<std::string>& topics,
+                                       const std::vector<std::string>& fields,
+                                       const std::vector<std::string>& options,
+                                       size_t queueSize, bool keepUnknown, double conflation)
+    : staging(fields.size(), 1024), defaultFields(vectorToCSVString(fields)),
+      defaultOptions(vectorToCSVString(options)), decoder(fields, keepUnknown),
+      service(MKTDATA_SERVICE), queue(queueSize), lvc(0, conflation) {
+
+    for (const auto& t : topics) {
+        if (topicIndex.count(t)) continue;
+        topicIndex.emplace(t, topics_.size());
+        topics_.push_back(t);
+        specs.push_back(TopicSpec{defaultFields, defaultOptions, true});
+    }
+    lvc.resize(topics_.size());
+    status.assign(topics_.size(), TopicStatus{"pending", ""});
+}
+
+SubscriptionEngine::~SubscriptionEngine() {
+    stop();
+}
+
+void SubscriptionEngine::record(const std::string& dir, size_t segmentSize, double rotateSeconds) {
+    try {
+        journal.reset(new JournalWriter(dir, segmentSize, rotateSeconds));
+        journal->setTopics(topics());
+        journal->setFields(decoder.names());
+    } catch (const std::exception& e) {
+        journal.reset();
+        Rcpp::stop(e.what());
+    }
+}
+
+void SubscriptionEngine::retain(size_t rows) {
+    std::lock_guard<std::mutex> lock(ringMutex);
+    ringRows = rows;
+    rings.assign(topics().size(), UpdateRing(rows));
+}
+
+void SubscriptionEngine::filterChanges(const std::vector<int>& triggers,
+                                       const std::vector<double>& tolerances) {
+    std::lock_guard<std::mutex> lock(lvcMutex);
+    lvc.filterChanges(triggers, tolerances);
+}
+
+void SubscriptionEngine::depth(size_t levels) {
+    std::lock_guard<std::mutex> lock(controlMutex);
+    service = MKTDEPTH_SERVICE;
+    bookLevels = std::max<size_t>(levels, 1);
+    // depth subscriptions take no fields
+    defaultFields.clear();
+    for (auto& spec : specs) spec.fields.clear();
+    std::lock_guard<std::mutex> bookLock(bookMutex);
+    books.assign(topics_.size(), OrderBook());
+}
+
+std::string SubscriptionEngine::subscriptionTopic(size_t cid) const {
+    const std::string& t = topics_[cid];
+    if (bookLevels == 0 || t.compare(0, 2, "//") == 0) return t;
+    // securities in Bloomberg notation default to tickers, as for //blp/mktdata
+    return service + (t[0] == '/' ? "" : "/ticker/") + t;
+}
+
+void SubscriptionEngine::start(const bbg::SessionOptions& sessionOptions) {
+    session.reset(new bbg::Session(sessionOptions, this));
+    if (!session->startAsync()) {
+        state_ = Failed;
+        session.reset();
+        Rcpp::stop("Failed to start session.");
+    }
+}
+
+void SubscriptionEngine::stop() {
+    stopping = true;
+    if (session) {
+        // blocks until the dispatcher has delivered its last event
+        session->stop();
+        session.reset();
+    }
+    if (journal) {
+        try {
+            journal->close();
+        } catch (const std::exception& e) {
+            setError(e.what());
+        }
+        journal.reset();
+    }
+    if (state() != Failed) setState(Stopped);
+}
+
+size_t SubscriptionEngine::pop(UpdateBuffer& buffer, size_t maxUpdates) {
+    Update u;
+    size_t n = 0;
+    while (n < maxUpdates && queue.pop(u)) {
+        buffer.append(u);
+        ++n;
+    }
+    // conflated updates held back for topics that have since gone quiet
+    std::vector<Update> held;
+    {
+        std::lock_guard<std::mutex> lock(lvcMutex);
+        if (lvc.conflating()) lvc.collectDue(currentTime(), held);
+    }
+    for (const auto& h : held) {
+        buffer.append(h);
+    }
+    return n + held.size();
+}
+
+void SubscriptionEngine::waitForUpdates(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(waitMutex);
+    published.wait_for(lock, timeout, [this]() { return queue.size() > 0 || state() > Running; });
+}
+
+void SubscriptionEngine::snapshot(UpdateBuffer& buffer) const {
+    std::lock_guard<std::mutex> lock(lvcMutex);
+    lvc.snapshot(buffer);
+}
+
+void SubscriptionEngine::window(const std::vector<size_t>& topics, size_t n, double since,
+                                UpdateBuffer& buffer) const {
+    // copied out under the lock, converted to columns outside of it
+    std::vector<Update> rows;
+    {
+        std::lock_guard<std::mutex> lock(ringMutex);
+        if (topics.empty()) {
+            for (const auto& r : rings) r.window(n, since, rows);
+        } else {
+            for (size_t t : topics) {
+                if (t < rings.size()) rings[t].window(n, since, rows);
+            }
+        }
+    }
+    std::stable_sort(rows.begin(), rows.end(),
+                     [](const Update& a, const Update& b) { return a.received < b.received; });
+    for (const auto& u : rows) {
+        buffer.append(u);
+    }
+}
+
+void SubscriptionEngine::bookSnapshot(const std::vector<size_t>& topics, size_t n, std::vector<int>& topic,
+                                      std::vector<int>& side, std::vector<int>& position,
+                                      std::vector<BookLevel>& levels) const {
+    std::lock_guard<std::mutex> lock(bookMutex);
+    auto copy = [&](size_t t) {
+        if (t >= books.size()) return;
+        for (int s = OrderBook::Bid; s <= OrderBook::Ask; ++s) {
+            const std::vector<BookLevel>& v = books[t].side(static_cast<OrderBook::Side>(s));
+            const size_t m = n > 0 ? std::min(n, v.size()) : v.size();
+            for (size_t i = 0; i < m; ++i) {
+                topic.push_back(static_cast<int>(t));
+                side.push_back(s);
+                position.push_back(static_cast<int>(i + 1));
+                levels.push_back(v[i]);
+            }
+        }
+    };
+    if (topics.empty()) {
+        for (size_t t = 0; t < books.size(); ++t) copy(t);
+    } else {
+        for (size_t t : topics) copy(t);
+    }
+}
+
+size_t SubscriptionEngine::retained() const {
+    std::lock_guard<std::mutex> lock(ringMutex);
+    size_t n = 0;
+    for (const auto& r : rings) n += r.size();
+    return n;
+}
+
+size_t SubscriptionEngine::lookup(const std::string& topic) const {
+    auto it = topicIndex.find(topic);
+    if (it == topicIndex.end() || !specs[it->second].active) {
+        Rcpp::stop("'" + topic + "' is not subscribed.");
+    }
+    return it->second;
+}
+
+std::string SubscriptionEngine::fieldList(const std::vector<std::string>& fields) {
+    for (const auto& f : fields) {
+        decoder.addField(f);
+    }
+    return vectorToCSVString(fields);
+}
+
+void SubscriptionEngine::setStatus(size_t cid, const TopicStatus& s) {
+    std::lock_guard<std::mutex> lock(statusMutex);
+    if (cid >= status.size()) status.resize(cid + 1);
+    status[cid] = s;
+}
+
+void SubscriptionEngine::add(const std::vector<std::string>& topics,
+                             const std::vector<std::string>* fields,
+                             const std::vector<std::string>* options) {
+    if (state() > Running) Rcpp::stop("Subscription is no longer running.");
+    std::vector<size_t> cids;
+    bool live;
+    {
+        std::lock_guard<std::mutex> lock(controlMutex);
+        for (const auto& t : topics) {
+            auto it = topicIndex.find(t);
+            if (it != topicIndex.end() && specs[it->second].active) {
+                Rcpp::stop("'" + t + "' is already subscribed.");
+            }
+        }
+        if (bookLevels > 0 && fields) Rcpp::stop("Market depth subscriptions take no fields.");
+        const std::string f = fields ? fieldList(*fields) : defaultFields;
+        const std::string o = options ? vectorToCSVString(*options) : defaultOptions;
+        for (const auto& t : topics) {
+            auto it = topicIndex.find(t);
+            size_t cid;
+            if (it != topicIndex.end()) {
+                cid = it->second;       // subscribed before, keeps its id and last values
+                specs[cid] = TopicSpec{f, o, true};
+            } else {
+                cid = topics_.size();
+                topicIndex.emplace(t, cid);
+                topics_.push_back(t);
+                specs.push_back(TopicSpec{f, o, true});
+            }
+            cids.push_back(cid);
+            setStatus(cid, TopicStatus{"pending", ""});
+        }
+        {
+            std::lock_guard<std::mutex> lvcLock(lvcMutex);
+            lvc.resize(topics_.size());
+        }
+        {
+            std::lock_guard<std::mutex> ringLock(ringMutex);
+            if (ringRows > 0) rings.resize(topics_.size(), UpdateRing(ringRows));
+        }
+        if (bookLevels > 0) {
+            std::lock_guard<std::mutex> bookLock(bookMutex);
+            books.resize(topics_.size());
+        }
+        if (barInterval > 0) {
+            // new topics have no history and roll bars from their first trade
+            std::lock_guard<std::mutex> barsLock(barsMutex);
+            builders.resize(topics_.size(), BarBuilder(barInterval, barCapacity));
+        }
+        // before the service is open everything active is subscribed in one go
+        live = state() == Running;
+    }
+    if (live) send(Subscribe, cids);
+}
+
+void SubscriptionEngine::remove(const std::vector<std::string>& topics) {
+    if (state() > Running) Rcpp::stop("Subscription is no longer running.");
+    std::vector<size_t> cids;
+    bool live;
+    {
+        std::lock_guard<std::mutex> lock(controlMutex);
+        for (const auto& t : topics) {
+            cids.push_back(lookup(t));
+        }
+        for (size_t cid : cids) {
+            specs[cid].active = false;  // late data for it is ignored from here on
+            setStatus(cid, TopicStatus{"unsubscribed", ""});
+        }
+        live = state() == Running;
+    }
+    if (live) send(Unsubscribe, cids);
+}
+
+void SubscriptionEngine::modify(const std::vector<std::string>& topics,
+                                const std::vector<std::string>* fields,
+                                const std::vector<std::string>* options) {
+    if (state() > Running) Rcpp::stop("Subscription is no longer running.");
+    std::vector<size_t> cids;
+    bool live;
+    {
+        std::lock_guard<std::mutex> lock(controlMutex);
+        for (const auto& t : topics) {
+            cids.push_back(lookup(t));
+        }
+        if (bookLevels > 0 && fields) Rcpp::stop("Market depth subscriptions take no fields.");
+        const std::string f = fields ? fieldList(*fields) : std::string();
+        const std::string o = options ? vectorToCSVString(*options) : std::string();
+        for (size_t cid : cids) {
+            if (fields) specs[cid].fields = f;
+            if (options) specs[cid].options = o;
+            setStatus(cid, TopicStatus{"pending", ""});
+        }
+        live = state() == Running;
+    }
+    if (live) send(Resubscribe, cids);
+}
+
+void SubscriptionEngine::addAnalytic(const std::vector<std::string>& topics, const std::string& name,
+                                     const std::string& type, const std::string& field,
+                                     const std::string& sizeField, double window) {
+    std::lock_guard<std::mutex> lock(controlMutex);
+    const std::vector<std::string> names = decoder.names();
+    auto slotOf = [&](const std::string& f) {
+        auto it = std::find(names.begin(), names.end(), f);
+        if (it == names.end()) Rcpp::stop("Field '" + f + "' is not subscribed.");
+        return static_cast<size_t>(it - names.begin());
+    };
+    AnalyticsRegistry::Input input;
+    if (field == "MID") {
+        input.mid = true;
+        input.slot = slotOf("BID");
+        input.askSlot = slotOf("ASK");
+    } else {
+        input.slot = slotOf(field);
+    }
+    if (type == "vwap") {
+        if (sizeField.empty()) Rcpp::stop("A size field is needed for a volume weighted average.");
+        input.sized = true;
+        input.sizeSlot = slotOf(sizeField);
+    }
+    std::vector<size_t> cids;
+    if (topics.empty()) {
+        for (size_t i = 0; i < specs.size(); ++i) {
+            if (specs[i].active) cids.push_back(i);
+        }
+    } else {
+        for (const auto& t : topics) cids.push_back(lookup(t));
+    }
+    std::lock_guard<std::mutex> analyticsLock(analyticsMutex);
+    if (registry.contains(name)) Rcpp::stop("Operator '" + name + "' exists already.");
+    try {
+        for (size_t cid : cids) {
+            registry.add(static_cast<int>(cid), name, type, input, window);
+        }
+    } catch (const std::exception& e) {
+        registry.remove(name);
+        Rcpp::stop(e.what());
+    }
+}
+
+void SubscriptionEngine::removeAnalytic(const std::string& name) {
+    std::lock_guard<std::mutex> lock(analyticsMutex);
+    registry.remove(name);
+}
+
+void SubscriptionEngine::analytics(std::vector<AnalyticsRegistry::Output>& out) {
+    std::lock_guard<std::mutex> lock(analyticsMutex);
+    registry.outputs(currentTime(), out);
+}
+
+void SubscriptionEngine::beginBars(const std::string& eventType, const std::string& priceField,
+                                   const std::string& sizeField) {
+    std::lock_guard<std::mutex> lock(controlMutex);
+    if (!barEvent.empty()) Rcpp::stop("Bars are already enabled.");
+    priceSlot = decoder.addField(priceField);
+    sizeSlot = decoder.addField(sizeField);
+    barEvent = eventType == "TRADE" ? "TRADE" : "QUOTE";
+    std::lock_guard<std::mutex> barsLock(barsMutex);
+    held.clear();
+}
+
+void SubscriptionEngine::enableBars(int interval, size_t capacity, const std::vector<Bars>& history,
+                                    double end) {
+    if (interval <= 0) Rcpp::stop("Bar interval must be positive.");
+    std::lock_guard<std::mutex> lock(controlMutex);
+    if (barEvent.empty() || barInterval > 0) Rcpp::stop("Bars are not being started.");
+    std::lock_guard<std::mutex> barsLock(barsMutex);
+    // topics added while the history was fetched start without one
+    builders.assign(topics_.size(), BarBuilder(interval, capacity));
+    for (size_t i = 0; i < history.size() && i < builders.size(); ++i) builders[i].seed(history[i]);
+    // earlier trades are part of the history
+    for (const HeldTrade& t : held) {
+        if (t.time >= end) builders[t.topic].trade(t.time, t.price, t.size);
+    }
+    std::vector<HeldTrade>().swap(held);
+    barCapacity = capacity;
+    barInterval = interval;
+}
+
+void SubscriptionEngine::abortBars() {
+    std::lock_guard<std::mutex> lock(controlMutex);
+    if (barInterval > 0) return;
+    barEvent.clear();
+    std::lock_guard<std::mutex> barsLock(barsMutex);
+    std::vector<HeldTrade>().swap(held);
+}
+
+void SubscriptionEngine::bars(std::vector<int>& topic, Bars& out, size_t n, bool withCurrent) {
+    std::lock_guard<std::mutex> lock(barsMutex);
+    const double now = currentTime();
+    for (size_t i = 0; i < builders.size(); ++i) {
+        BarBuilder& b = builders[i];
+        b.roll(now);
+        b.completed(out, n);
+        Bar bar;
+        if (withCurrent && b.current(bar)) {
+            out.push_back(bar.time, bar.open, bar.high, bar.low, bar.close, bar.numEvents,
+                          bar.volume, bar.value);
+        }
+        topic.resize(out.size(), static_cast<int>(i));
+    }
+}
+
+void SubscriptionEngine::send(Request request, const std::vector<size_t>& cids) {
+    if (cids.empty()) return;
+    bbg::SubscriptionList list;
+    {
+        std::lock_guard<std::mutex> lock(controlMutex);
+        for (size_t cid : cids) {
+            list.add(subscriptionTopic(cid).c_str(), specs[cid].fields.c_str(), specs[cid].options.c_str(),
+                     bbg::CorrelationId(static_cast<long long>(cid)));
+        }
+    }
+    // outside of controlMutex as the session may wait for the dispatcher
+    try {
+        switch (request) {
+        case Subscribe:
+            session->subscribe(list);
+            break;
+        case Unsubscribe:
+            session->unsubscribe(list);
+            break;
+        case Resubscribe:
+            session->resubscribe(list);
+            break;
+        }
+    } catch (const bbg::Exception& e) {
+        Rcpp::stop(e.description());
+    }
+}
+
+bool SubscriptionEngine::processEvent(const bbg::Event& event, bbg::Session* session) {
+    // nothing may escape into the dispatcher
+    try {
+        switch (event.eventType()) {
+        case bbg::Event::SUBSCRIPTION_DATA:
+            onSubscriptionData(event);
+            break;
+        case bbg::Event::SUBSCRIPTION_STATUS:
+            onSubscriptionStatus(event);
+            break;
+        case bbg::Event::SESSION_STATUS:
+            onSessionStatus(event, session);
+            break;
+        case bbg::Event::SERVICE_STATUS:
+            onServiceStatus(event, session);
+            break;
+        default:
+            break;
+        }
+    } catch (const bbg::Exception& e) {
+        setError(e.description());
+    } catch (const std::exception& e) {
+        setError(e.what());
+    } catch (...) {
+        setError("Unknown error in subscription event handler.");
+    }
+    return true;
+}
+
+void SubscriptionEngine::onSessionStatus(const bbg::Event& event, bbg::Session* session) {
+    bbg::MessageIterator msgIter(event);
+    while (msgIter.next()) {
+        bbg::Message msg = msgIter.message();
+        if (msg.messageType() == SESSION_STARTED) {
+            // the schema is needed to compile the decoder before subscribing
+            session->openServiceAsync(service.c_str());
+        } else if (msg.messageType() == SESSION_STARTUP_FAILURE) {
+            setError("Session startup failure.");
+            setState(Failed);
+        } else if (msg.messageType() == SESSION_TERMINATED) {
+            // only expected once stop() was called, otherwise the session died
+            if (state() <= Running && !stopping) {
+                setError("Session terminated.");
+                setState(Failed);
+            }
+        }
+    }
+}
+
+void SubscriptionEngine::onServiceStatus(const bbg::Event& event, bbg::Session* session) {
+    bbg::MessageIterator msgIter(event);
+    while (msgIter.next()) {
+        bbg::Message msg = msgIter.message();
+        if (msg.messageType() == SERVICE_OPENED) {
+            bbg::SubscriptionList subscriptions;
+            {
+                std::lock_guard<std::mutex> lock(controlMutex);
+                decoder.compile(session->getService(service.c_str()));
+                for (size_t i = 0; i < topics_.size(); ++i) {
+                    if (!specs[i].active) continue;
+                    subscriptions.add(subscriptionTopic(i).c_str(), specs[i].fields.c_str(), specs[i].options.c_str(),
+                                      bbg::CorrelationId(static_cast<long long>(i)));
+                }
+                // from here on topics added from R are subscribed right away
+                state_ = Running;
+            }
+            if (subscriptions.size() > 0) session->subscribe(subscriptions);
+        } else if (msg.messageType() == SERVICE_OPEN_FAILURE) {
+            setError("Failed to open " + service);
+            setState(Failed);
+        }
+    }
+}
+
+void SubscriptionEngine::onSubscriptionStatus(const bbg::Event& event) {
+    bbg::MessageIterator msgIter(event);
+    std::lock_guard<std::mutex> control(controlMutex);
+    std::lock_guard<std::mutex> lock(statusMutex);
+    while (msgIter.next()) {
+        bbg::Message msg = msgIter.message();
+        size_t cid(msg.correlationId().asInteger());
+        if (cid >= status.size() || !specs[cid].active) continue;
+        if (msg.messageType() == SUBSCRIPTION_STARTED) {
+            status[cid] = TopicStatus{"subscribed", ""};
+            if (bookLevels > 0) {
+                // the initial paint that follows rebuilds the book
+                std::lock_guard<std::mutex> bookLock(bookMutex);
+                if (cid < books.size()) books[cid].clear();
+            }
+        } else if (msg.messageType() == SUBSCRIPTION_FAILURE) {
+            status[cid] = TopicStatus{"failed", reasonOf(msg)};
+        } else if (msg.messageType() == SUBSCRIPTION_TERMINATED) {
+            status[cid] = TopicStatus{"terminated", reasonOf(msg)};
+        }
+    }
+}
+
+void SubscriptionEngine::onSubscriptionData(const bbg::Event& event) {
+    bbg::MessageIterator msgIter(event);
+    std::lock_guard<std::mutex> control(controlMutex);
+    while (msgIter.next()) {
+        bbg::Message msg = msgIter.message();
+        size_t cid(msg.correlationId().asInteger());
+        if (cid >= specs.size() || !specs[cid].active) continue;
+        Update u;
+        if (bookLevels > 0) {
+            if (!bookUpdate(msg, cid, u)) continue;
+        } else if (!decoder.decode(msg, static_cast<int>(cid), u)) {
+            continue;
+        }
+        ++received_;
+        if (journal) journalUpdate(u);
+        if (!barEvent.empty()) barUpdate(msg, u);
+        {
+            std::lock_guard<std::mutex> lock(analyticsMutex);
+            if (registry.size() > 0) registry.update(u);
+        }
+        {
+            std::lock_guard<std::mutex> lock(ringMutex);
+            if (cid < rings.size()) rings[cid].append(u);
+        }
+        bool emit;
+        {
+            std::lock_guard<std::mutex> lock(lvcMutex);
+            emit = lvc.update(u);
+            if (emit && lvc.conflating()) lvc.row(u.topic, u);
+        }
+        if (emit) publish(std::move(u));
+    }
+    {
+        std::lock_guard<std::mutex> lock(lvcMutex);
+        if (lvc.conflating()) lvc.collectDue(currentTime(), due);
+    }
+    for (auto& u : due) {
+        publish(std::move(u));
+    }
+    due.clear();
+}
+
+bool SubscriptionEngine::bookUpdate(const bbg::Message& msg, size_t cid, Update& u) {
+    std::lock_guard<std::mutex> lock(bookMutex);
+    if (cid >= books.size() || !applyDepthMessage(msg, books[cid])) return false;
+    u.topic = static_cast<int>(cid);
+    u.received = currentTime();
+    books[cid].metrics(bookLevels, u);
+    return true;
+}
+
+void SubscriptionEngine::barUpdate(const bbg::Message& msg, const Update& u) {
+    if (u.values.size() <= std::max(priceSlot, sizeSlot) || u.values[priceSlot].isNull()) return;
+    // neither the initial paint nor cancellations and corrections are trades
+    if (!msg.hasElement(MKTDATA_EVENT_TYPE) ||
+        std::strcmp(msg.getElementAsString(MKTDATA_EVENT_TYPE), barEvent.c_str()) != 0) return;
+    if (msg.hasElement(MKTDATA_EVENT_SUBTYPE)) {
+        const char* subtype = msg.getElementAsString(MKTDATA_EVENT_SUBTYPE);
+        if (std::strcmp(subtype, "CANCEL") == 0 || std::strcmp(subtype, "CORRECTION") == 0) return;
+    }
+    const FieldValue& size = u.values[sizeSlot];
+    const double volume = size.isNull() ? 0.0 : size.num;
+    std::lock_guard<std::mutex> lock(barsMutex);
+    if (barInterval == 0) {
+        held.push_back(HeldTrade{u.topic, u.received, u.values[priceSlot].num, volume});
+    } else if (static_cast<size_t>(u.topic) < builders.size()) {
+        builders[u.topic].trade(u.received, u.values[priceSlot].num, volume);
+    }
+}
+
+void SubscriptionEngine::journalUpdate(const Update& u) {
+    try {
+        if (topics_.size() > journal->numTopics()) {
+            journal->setTopics(topics_);            // topics were added
+        }
+        if (u.values.size() > journal->numFields()) {
+            journal->setFields(decoder.names());    // unknown elements were kept
+        }
+        journal->append(u);
+        ++recorded_;
+    } catch (const std::exception& e) {
+        // recording stops, the subscription carries on
+        setError(std::string("Journal: ") + e.what());
+        journal.reset();
+    }
+}
+
+void SubscriptionEngine::publish(Update&& u) {
+    // never block the dispatcher: when R falls behind the newest updates are dropped
+    if (!queue.push(std::move(u))) {
+        ++dropped_;
+        return;
+    }
+    // cheap without a waiter; a wakeup missed by a poll just starting to
+    // wait costs it at most one slice
+    published.notify_one();
+}
+
+void SubscriptionEngine::setState(State s) {
+    {
+        // under the lock so that a poll between its check and its wait sees it
+        std::lock_guard<std::mutex> lock(waitMutex);
+        state_ = s;
+    }
+    published.notify_all();
+}
+
+void SubscriptionEngine::setError(const std::string& msg) {
+    std::lock_guard<std::mutex> lock(statusMutex);
+    error = msg;
+}
+
+std::vector<SubscriptionEngine::TopicStatus> SubscriptionEngine::topicStatus() const {
+    std::lock_guard<std::mutex> lock(statusMutex);
+    return status;
+}
+
+std::vector<std::string> SubscriptionEngine::topics() const {
+    std::lock_guard<std::mutex> lock(controlMutex);
+    return topics_;
+}
+
+std::string SubscriptionEngine::lastError() const {
+    std::lock_guard<std::mutex> lock(statusMutex);
+    return error;
+}
+
+static void engineFinalizer(SEXP engine_) {
+    SubscriptionEngine* engine = reinterpret_cast<SubscriptionEngine*>(R_ExternalPtrAddr(engine_));
+    if (engine) {
+        delete engine;
+        R_ClearExternalPtr(engine_);
+    }
+}
+#else
+#include <Rcpp/Lightest>
+#endif
+
+// [[Rcpp::export]]
+SEXP subscribeAsync_Impl(const std::string host, const int port, SEXP app_name_, SEXP app_identity_key_,
+                         std::vector<std::string> securities, std::vector<std::string> fields,
+                         SEXP options_, int queueSize, bool keepUnknown=false, int conflate=0,
+                         SEXP journal_=R_NilValue, double journalSegmentSize=64.0, double journalRotate=0.0,
+                         int retainRows=0, double retainBytes=0.0, int depthLevels=0,
+                         SEXP changes_=R_NilValue, SEXP tolerance_=R_NilValue) {
+#if defined(HaveBlp)
+    std::vector<std::string> options;
+    if (options_ != R_NilValue && Rf_length(options_)) {
+        options = Rcpp::as< std::vector<std::string> >(options_);
+    }
+    if (depthLevels > 0) fields = OrderBook::metricNames();
+    // every argument is checked before anything is created on disk
+    if (retainBytes > 0) {
+        // a memory budget for the whole subscription, shared evenly by the topics
+        retainRows = static_cast<int>(retainBytes / (UpdateRing::rowBytes(fields.size()) *
+                                                     std::max<size_t>(securities.size(), 1)));
+        if (retainRows < 1) Rcpp::stop("Memory budget too small to retain any update.");
+    }
+    std::vector<int> triggers;
+    std::vector<double> tolerances;
+    const bool filter = changeFilterFromR(changes_, tolerance_, fields, triggers, tolerances);
+
+    SubscriptionEngine* engine = new SubscriptionEngine(securities, fields, options, queueSize, keepUnknown,
+                                                      conflate / 1000.0);
+    SEXP engine_ = Rcpp::Shield<SEXP>(createExternalPointer<SubscriptionEngine>(engine, engineFinalizer,
+                                                                                 "Rblpapi::SubscriptionEngine*"));
+    if (retainRows > 0) engine->retain(static_cast<size_t>(retainRows));
+    if (depthLevels > 0) engine->depth(static_cast<size_t>(depthLevels));
+    if (filter) engine->filterChanges(triggers, tolerances);
+    if (journal_ != R_NilValue) {
+        engine->record(Rcpp::as<std::string>(journal_),
+                       static_cast<size_t>(journalSegmentSize * 1024 * 1024), journalRotate);
+    }
+    engine->start(createSessionOptions(host, port, app_name_, app_identity_key_));
+    return engine_;
+#else // ie no Blp
+    return R_NilValue;
+#endif
+}
+
+// [[Rcpp::export]]
+SEXP pollSubscription_Impl(SEXP engine_, int maxUpdates, int timeout) {
+#if defined(HaveBlp)
+    SubscriptionEngine* engine =
+        reinterpret_cast<SubscriptionEngine*>(checkExternalPointer(engine_, "Rblpapi::SubscriptionEngine*"));
+    UpdateBuffer& buffer = engine->staging;
+    buffer.clear();
+    // without a limit take what is queued now rather than chasing the producer
+    auto popAvailable = [&]() {
+        engine->pop(buffer, maxUpdates > 0 ? static_cast<size_t>(maxUpdates) : engine->queued());
+    };
+    popAvailable();
+
+    // optionally wait for the first update, woken by the dispatcher as it
+    // queues one, in slices of at most 100ms so that interrupts are seen
+    using clock = std::chrono::steady_clock;
+    const clock::time_point deadline = clock::now() + std::chrono::milliseconds(timeout);
+    for (clock::time_point now = clock::now();
+         buffer.size() == 0 && timeout > 0 && now < deadline && engine->state() <= SubscriptionEngine::Running;
+         now = clock::now()) {
+        engine->waitForUpdates(std::min(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now) +
+                                        std::chrono::milliseconds(1),
+                                        std::chrono::milliseconds(100)));
+        Rcpp::checkUserInterrupt();
+        popAvailable();
+    }
+    Rcpp::List ans = updatesToDataFrame(buffer, engine->topics(), engine->fields());
+    buffer.clear();
+    return ans;
+#else // ie no Blp
+    return R_NilValue;
+#endif
+}
+
+// [[Rcpp::export]]
+SEXP subscriptionSnapshot_Impl(SEXP engine_) {
+#if defined(HaveBlp)
+    SubscriptionEngine* engine =
+        reinterpret_cast<SubscriptionEngine*>(checkExternalPointer(engine_, "Rblpapi::SubscriptionEngine*"));
+    UpdateBuffer buffer(0, 64);
+    engine->snapshot(buffer);
+    // names taken after the rows so that they cover every topic and column in there
+    return updatesToDataFrame(buffer, engine->topics(), engine->fields());
+#else // ie no Blp
+    return R_NilValue;
+#endif
+}
+
+// [[Rcpp::export]]
+SEXP changeSubscription_Impl(SEXP engine_, const std::string action, std::vector<std::string> securities,
+                             SEXP fields_, SEXP options_) {
+#if defined(HaveBlp)
+    SubscriptionEngine* engine =
+        reinterpret_cast<SubscriptionEngine*>(checkExternalPointer(engine_, "Rblpapi::SubscriptionEngine*"));
+    std::vector<std::string> fields, options;
+    if (fields_ != R_NilValue) fields = Rcpp::as< std::vector<std::string> >(fields_);
+    if (options_ != R_NilValue) options = Rcpp::as< std::vector<std::string> >(options_);
+    const std::vector<std::string>* f = fields_ != R_NilValue ? &fields : nullptr;
+    const std::vector<std::string>* o = options_ != R_NilValue ? &options : nullptr;
+    if (action == "add") {
+        engine->add(securities, f, o);
+    } else if (action == "remove") {
+        engine->remove(securities);
+    } else if (action == "modify") {
+        engine->modify(securities, f, o);
+    } else {
+        Rcpp::stop("Unknown action '" + action + "'.");
+    }
+#endif
+    return R_NilValue;
+}
+
+// [[Rcpp::export]]
+SEXP subscriptionBars_Impl(SEXP engine_, SEXP con, int barInterval, int capacity, const std::string eventType,
+                           const std::string priceField, const std::string sizeField, double startTime) {
+#if defined(HaveBlp)
+    SubscriptionEngine* engine =
+        reinterpret_cast<SubscriptionEngine*>(checkExternalPointer(engine_, "Rblpapi::SubscriptionEngine*"));
+    if (barInterval <= 0) Rcpp::stop("Bar interval must be positive.");
+    // trades are held from here on, so that none is lost while the history is fetched
+    engine->beginBars(eventType, priceField, sizeField);
+    const std::vector<std::string> topics = engine->topics();
+    const double end = currentTime();
+    std::vector<Bars> history(topics.size());
+    if (startTime > 0) {
+        try {
+            // one request per security, all in flight at once; nothing is
+            // seeded unless every history arrived complete
+            ConnectionEngine requests(con);
+            const std::string start = posixToRequestString(startTime), until = posixToRequestString(end);
+            std::vector<std::shared_ptr<BufferedRequestState>> states;
+            for (const auto& topic : topics) {
+                states.push_back(sendBarRequest(requests, topic, eventType, barInterval, start, until,
+                                                R_NilValue, false));
+            }
+            try {
+                for (size_t i = 0; i < topics.size(); ++i) {
+                    if (!collectBars(requests, states[i], barInterval, false, history[i])) {
+                        Rcpp::stop("Bar request for '" + topics[i] + "' failed, bars are not enabled.");
+                    }
+                }
+            } catch (...) {
+                for (const auto& state : states) requests->cancel(state);
+                throw;
+            }
+        } catch (...) {
+            engine->abortBars();
+            throw;
+        }
+    }
+    engine->enableBars(barInterval, static_cast<size_t>(capacity), history, end);
+#endif
+    return R_NilValue;
+}
+
+// [[Rcpp::export]]
+Rcpp::DataFrame getSubscriptionBars_Impl(SEXP engine_, int n, bool current) {
+#if defined(HaveBlp)
+    SubscriptionEngine* engine =
+        reinterpret_cast<SubscriptionEngine*>(checkExternalPointer(engine_, "Rblpapi::SubscriptionEngine*"));
+    std::vector<int> topic;
+    Bars bars;
+    engine->bars(topic, bars, n > 0 ? static_cast<size_t>(n) : 0, current);
+    // correlation ids are zero-based
+    Rcpp::IntegerVector topic_(topic.size());
+    for (size_t i = 0; i < topic.size(); ++i) {
+        topic_[i] = topic[i] + 1;
+    }
+    topic_.attr("levels") = Rcpp::wrap(engine->topics());
+    topic_.attr("class") = "factor";
+    return Rcpp::DataFrame::create(Rcpp::Named("topic")     = topic_,
+                                   Rcpp::Named("times")     = createPOSIXtVector(bars.time),
+                                   Rcpp::Named("open")      = bars.open,
+                                   Rcpp::Named("high")      = bars.high,
+                                   Rcpp::Named("low")       = bars.low,
+                                   Rcpp::Named("close")     = bars.close,
+                                   Rcpp::Named("numEvents") = bars.numEvents,
+                                   Rcpp::Named("volume")    = bars.volume,
+                                   Rcpp::Named("value")     = bars.value);
+#else // ie no Blp
+    return Rcpp::DataFrame();
+#endif
+}
+
+// [[Rcpp::export]]
+SEXP subscriptionWindow_Impl(SEXP engine_, SEXP securities_, int n, double since) {
+#if defined(HaveBlp)
+    SubscriptionEngine* engine =
+        reinterpret_cast<SubscriptionEngine*>(checkExternalPointer(engine_, "Rblpapi::SubscriptionEngine*"));
+    std::vector<size_t> topics;
+    if (securities_ != R_NilValue) {
+        const std::vector<std::string> all = engine->topics();
+        for (const auto& s : Rcpp::as< std::vector<std::string> >(securities_)) {
+            auto it = std::find(all.begin(), all.end(), s);
+            if (it == all.end()) Rcpp::stop("'" + s + "' is not subscribed.");
+            topics.push_back(static_cast<size_t>(it - all.begin()));
+        }
+    }
+    UpdateBuffer buffer(0, 1024);
+    engine->window(topics, n > 0 ? static_cast<size_t>(n) : 0, since, buffer);
+    return updatesToDataFrame(buffer, engine->topics(), engine->fields());
+#else // ie no Blp
+    return R_NilValue;
+#endif
+}
+
+// [[Rcpp::export]]
+Rcpp::DataFrame bookSnapshot_Impl(SEXP engine_, SEXP securities_, int n) {
+#if defined(HaveBlp)
+    SubscriptionEngine* engine =
+        reinterpret_cast<SubscriptionEngine*>(checkExternalPointer(engine_, "Rblpapi::SubscriptionEngine*"));
+    const std::vector<std::string> all = engine->topics();
+    std::vector<size_t> topics;
+    if (securities_ != R_NilValue) {
+        for (const auto& s : Rcpp::as< std::vector<std::string> >(securities_)) {
+            auto it = std::find(all.begin(), all.end(), s);
+            if (it == all.end()) Rcpp::stop("'" + s + "' is not subscribed.");
+            topics.push_back(static_cast<size_t>(it - all.begin()));
+        }
+    }
+    std::vector<int> topic, side, position;
+    std::vector<BookLevel> levels;
+    engine->bookSnapshot(topics, n > 0 ? static_cast<size_t>(n) : 0, topic, side, position, levels);
+
+    const size_t m = levels.size();
+    Rcpp::IntegerVector topic_(m), side_(m), orders(m);
+    Rcpp::NumericVector price(m), size(m);
+    for (size_t i = 0; i < m; ++i) {
+        topic_[i] = topic[i] + 1;
+        side_[i] = side[i] + 1;
+        price[i] = levels[i].price;
+        size[i] = levels[i].size;
+        orders[i] = levels[i].orders;
+    }
+    topic_.attr("levels") = Rcpp::wrap(all);
+    topic_.attr("class") = "factor";
+    side_.attr("levels") = Rcpp::CharacterVector::create("bid", "ask");
+    side_.attr("class") = "factor";
+    return Rcpp::DataFrame::create(Rcpp::Named("topic")    = topic_,
+                                   Rcpp::Named("side")     = side_,
+                                   Rcpp::Named("position") = position,
+                                   Rcpp::Named("price")    = price,
+                                   Rcpp::Named("size")     = size,
+                                   Rcpp::Named("orders")   = orders);
+#else // ie no Blp
+    return Rcpp::DataFrame();
+#endif
+}
+
+// [[Rcpp::export]]
+SEXP changeAnalytics_Impl(SEXP engine_, const std::string action, const std::string name, SEXP securities_,
+                          const std::string type, const std::string field, const std::string sizeField,
+                          double window) {
+#if defined(HaveBlp)
+    SubscriptionEngine* engine =
+        reinterpret_cast<SubscriptionEngine*>(checkExternalPointer(engine_, "Rblpapi::SubscriptionEngine*"));
+    if (action == "add") {
+        std::vector<std::string> securities;
+        if (securities_ != R_NilValue) securities = Rcpp::as< std::vector<std::string> >(securities_);
+        engine->addAnalytic(securities, name, type, field, sizeField, window);
+    } else {
+        engine->removeAnalytic(name);
+    }
+#endif
+    return R_NilValue;
+}
+
+// [[Rcpp::export]]
+Rcpp::DataFrame subscriptionAnalytics_Impl(SEXP engine_) {
+#if defined(HaveBlp)
+    SubscriptionEngine* engine =
+        reinterpret_cast<SubscriptionEngine*>(checkExternalPointer(engine_, "Rblpapi::SubscriptionEngine*"));
+    std::vector<AnalyticsRegistry::Output> out;
+    engine->analytics(out);
+    const size_t n = out.size();
+    Rcpp::IntegerVector topic(n);
+    Rcpp::CharacterVector name(n), type(n);
+    Rcpp::NumericVector value(n), count(n);
+    std::vector<double> time(n);
+    for (size_t i = 0; i < n; ++i) {
+        topic[i] = out[i].topic + 1;
+        name[i] = out[i].name;
+        type[i] = out[i].type;
+        value[i] = out[i].value;
+        time[i] = out[i].time;
+        count[i] = static_cast<double>(out[i].count);
+    }
+    topic.attr("levels") = Rcpp::wrap(engine->topics());
+    topic.attr("class") = "factor";
+    return Rcpp::DataFrame::create(Rcpp::Named("topic") = topic,
+                                   Rcpp::Named("name")  = name,
+                                   Rcpp::Named("type")  = type,
+                                   Rcpp::Named("value") = value,
+                                   Rcpp::Named("time")  = createPOSIXtVector(time),
+                                   Rcpp::Named("count") = count,
+                                   Rcpp::Named("stringsAsFactors") = false);
+#else // ie no Blp
+    return Rcpp::DataFrame();
+#endif
+}
+
+// [[Rcpp::export]]
+SEXP stopSubscription_Impl(SEXP engine_) {
+#if defined(HaveBlp)
+    SubscriptionEngine* engine =
+        reinterpret_cast<SubscriptionEngine*>(checkExternalPointer(engine_, "Rblpapi::SubscriptionEngine*"));
+    engine->stop();
+#endif
+    return R_NilValue;
+}
+
+// [[Rcpp::export]]
+Rcpp::List subscriptionStatus_Impl(SEXP engine_) {
+#if defined(HaveBlp)
+    SubscriptionEngine* engine =
+        reinterpret_cast<SubscriptionEngine*>(checkExternalPointer(engine_, "Rblpapi::SubscriptionEngine*"));
+    std::vector<SubscriptionEngine::TopicStatus> status = engine->topicStatus();
+    Rcpp::CharacterVector topicStatus(status.size()), reason(status.size());
+    for (size_t i = 0; i < status.size(); ++i) {
+        topicStatus[i] = status[i].status;
+        reason[i] = status[i].reason;
+    }
+    return Rcpp::List::create(Rcpp::Named("state") = stateNames[engine->state()],
+                              Rcpp::Named("received") = static_cast<double>(engine->received()),
+                              Rcpp::Named("dropped") = static_cast<double>(engine->dropped()),
+                              Rcpp::Named("queued") = static_cast<double>(engine->queued()),
+                              Rcpp::Named("recorded") = static_cast<double>(engine->recorded()),
+                              Rcpp::Named("retained") = static_cast<double>(engine->retained()),
+                              Rcpp::Named("topics") =
+                                  Rcpp::DataFrame::create(Rcpp::Named("topic") = engine->topics(),
+                                                          Rcpp::Named("status") = topicStatus,
+                                                          Rcpp::Named("reason") = reason,
+                                                          Rcpp::Named("stringsAsFactors") = false),
+                              Rcpp::Named("lastError") = engine->lastError());
+#else // ie no Blp
+    return Rcpp::List();
+#endif
+}
@@ -0,0 +1,220 @@
+// -*- mode: C++; c-indent-level: 4; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+//
+//  subscriptionengine.h -- market data subscriptions on a background thread
+//
+//  Copyright (C) 2026  Whit Armstrong and Dirk Eddelbuettel
+//
+//  This file is part of Rblpapi
+//
+//  Rblpapi is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  Rblpapi is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Rblpapi.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <blpapi_event.h>
+#include <blpapi_name.h>
+#include <blpapi_session.h>
+#include <blpapi_sessionoptions.h>
+#include <blpapi_subscriptionlist.h>
+#include <analytics.h>
+#include <bars.h>
+#include <journal.h>
+#include <orderbook.h>
+#include <spscqueue.h>
+#include <subscription.h>
+
+// Owns a session of its own whose events are handled on the blpapi dispatcher
+// thread. Data messages are decoded there and queued; the R thread only ever
+// pops from the queue, so R code never runs on the dispatcher thread and the
+// engine keeps ingesting while R is busy. A last-value table is kept for
+// snapshots at any time, and optionally conflates what is queued. Every
+// decoded update can also be recorded to a journal on the dispatcher thread.
+//
+// Topics can be added, removed or changed while the stream runs. A topic keeps
+// its id, which is also its correlation id, for the life of the engine, so the
+// last values and the columns already decoded survive any such change, and a
+// topic removed and added again continues where it left off.
+//
+// Optionally the most recent updates of every topic are retained in rings of
+// fixed capacity, and trades are rolled into intraday bars as they arrive.
+//
+// For market depth the engine subscribes to //blp/mktdepthdata instead and
+// keeps an order book per topic; its updates are then the book metrics.
+//
+// Incremental operators can be attached to topics and fields; they are updated
+// on the dispatcher thread and only their outputs are read from R.
+class SubscriptionEngine : public BloombergLP::blpapi::EventHandler {
+public:
+    enum State { Starting, Running, Stopped, Failed };
+
+    struct TopicStatus {
+        std::string status;             // pending, subscribed, failed, terminated or unsubscribed
+        std::string reason;
+    };
+
+    SubscriptionEngine(const std::vector<std::string>& topics,
+                       const std::vector<std::string>& fields,
+                       const std::vector<std::string>& options,
+                       size_t queueSize, bool keepUnknown, double conflation);
+    ~SubscriptionEngine();
+
+    // R thread
+    void record(const std::string& dir, size_t segmentSize, double rotateSeconds);
+    void retain(size_t rows);
+    // queue only updates changing one of the trigger slots (all if empty) beyond its tolerance
+    void filterChanges(const std::vector<int>& triggers, const std::vector<double>& tolerances);
+    // subscribe to market depth, with imbalance over the best 'levels' entries
+    void depth(size_t levels);
+    void start(const BloombergLP::blpapi::SessionOptions& sessionOptions);
+    void stop();
+    size_t pop(UpdateBuffer& buffer, size_t maxUpdates);
+    // blocks for at most 'timeout' until an update is queued or the engine has ended
+    void waitForUpdates(std::chrono::milliseconds timeout);
+    void snapshot(UpdateBuffer& buffer) const;
+    // retained updates of the given topics (all if empty), the last n per topic
+    // (all if zero) received at or after 'since', in receive order
+    void window(const std::vector<size_t>& topics, size_t n, double since, UpdateBuffer& buffer) const;
+    size_t retained() const;
+    // the best n entries (all if zero) of each side of the books of the given topics (all if empty)
+    void bookSnapshot(const std::vector<size_t>& topics, size_t n, std::vector<int>& topic,
+                      std::vector<int>& side, std::vector<int>& position, std::vector<BookLevel>& levels) const;
+
+    // R thread; null fields or options take the defaults for add and the
+    // current ones for modify
+    void add(const std::vector<std::string>& topics,
+             const std::vector<std::string>* fields, const std::vector<std::string>* options);
+    void remove(const std::vector<std::string>& topics);
+    void modify(const std::vector<std::string>& topics,
+                const std::vector<std::string>* fields, const std::vector<std::string>* options);
+
+    // R thread; field names the input, or is "MID" for the mid of BID and ASK
+    void addAnalytic(const std::vector<std::string>& topics, const std::string& name,
+                     const std::string& type, const std::string& field, const std::string& sizeField,
+                     double window);
+    void removeAnalytic(const std::string& name);
+    void analytics(std::vector<AnalyticsRegistry::Output>& out);
+
+    // R thread; bars are rolled from updates of the given event type carrying
+    // priceField. Trades are held from beginBars() on while the history is
+    // fetched, enableBars() then seeds every topic and rolls the trades held
+    // since 'end' into the bar in progress, all in one step, and abortBars()
+    // drops them when the history could not be had.
+    void beginBars(const std::string& eventType, const std::string& priceField, const std::string& sizeField);
+    void enableBars(int barInterval, size_t capacity, const std::vector<Bars>& history, double end);
+    void abortBars();
+    // the last n (all if zero) completed bars of every topic, optionally with the one in progress
+    void bars(std::vector<int>& topic, Bars& out, size_t n, bool withCurrent);
+
+    // dispatcher thread
+    bool processEvent(const BloombergLP::blpapi::Event& event,
+                      BloombergLP::blpapi::Session* session) override;
+
+    State state() const { return static_cast<State>(state_.load()); }
+    uint64_t received() const { return received_.load(); }
+    uint64_t dropped() const { return dropped_.load(); }
+    uint64_t recorded() const { return recorded_.load(); }
+    size_t queued() const { return queue.size(); }
+    std::vector<TopicStatus> topicStatus() const;
+    std::string lastError() const;
+
+    std::vector<std::string> topics() const;
+    std::vector<std::string> fields() const { return decoder.names(); }
+
+    UpdateBuffer staging;               // R thread only, keeps column types stable across polls
+
+private:
+    void onSessionStatus(const BloombergLP::blpapi::Event& event, BloombergLP::blpapi::Session* session);
+    void onServiceStatus(const BloombergLP::blpapi::Event& event, BloombergLP::blpapi::Session* session);
+    void onSubscriptionStatus(const BloombergLP::blpapi::Event& event);
+    void onSubscriptionData(const BloombergLP::blpapi::Event& event);
+    void publish(Update&& u);
+    void journalUpdate(const Update& u);
+    void barUpdate(const BloombergLP::blpapi::Message& msg, const Update& u);
+    bool bookUpdate(const BloombergLP::blpapi::Message& msg, size_t cid, Update& u);
+    std::string subscriptionTopic(size_t cid) const;
+    void setError(const std::string& msg);
+    void setState(State s);
+    size_t lookup(const std::string& topic) const;
+    std::string fieldList(const std::vector<std::string>& fields);
+    void setStatus(size_t cid, const TopicStatus& s);
+    enum Request { Subscribe, Unsubscribe, Resubscribe };
+    void send(Request request, const std::vector<size_t>& cids);
+
+    struct TopicSpec {
+        std::string fields;             // comma-separated, as subscribed
+        std::string options;
+        bool active;
+    };
+
+    mutable std::mutex controlMutex;    // guards the members below, held while decoding
+    std::vector<std::string> topics_;
+    std::vector<TopicSpec> specs;
+    std::unordered_map<std::string, size_t> topicIndex;
+    std::string defaultFields;
+    std::string defaultOptions;
+    UpdateDecoder decoder;              // slots only added under controlMutex
+    int barInterval = 0;                // minutes, zero until the bars are seeded
+    size_t barCapacity = 0;
+    std::string barEvent;               // MKTDATA_EVENT_TYPE of updates to roll into bars, empty without bars
+    size_t priceSlot = 0, sizeSlot = 0;
+
+    std::string service;
+    size_t bookLevels = 0;              // zero unless subscribed to market depth
+    std::unique_ptr<BloombergLP::blpapi::Session> session;
+    SpscQueue<Update> queue;
+
+    mutable std::mutex lvcMutex;        // guards lvc, which is also read from R
+    LastValueCache lvc;
+    std::vector<Update> due;            // dispatcher thread only
+    std::unique_ptr<JournalWriter> journal;     // dispatcher thread once started
+
+    mutable std::mutex ringMutex;       // guards the two members below
+    size_t ringRows = 0;
+    std::vector<UpdateRing> rings;
+
+    mutable std::mutex analyticsMutex;  // guards registry
+    AnalyticsRegistry registry;
+
+    mutable std::mutex bookMutex;       // guards books
+    std::vector<OrderBook> books;
+
+    struct HeldTrade {
+        int topic;
+        double time, price, size;
+    };
+    mutable std::mutex barsMutex;       // guards the two members below
+    std::vector<BarBuilder> builders;
+    std::vector<HeldTrade> held;        // trades received before the bars are seeded
+
+    std::atomic<int> state_{Starting};
+    std::atomic<bool> stopping{false};  // stop() was called, a terminated session is expected
+
+    std::mutex waitMutex;               // only for 'published', which is notified
+    std::condition_variable published;  // on every queued update and when the engine ends
+    std::atomic<uint64_t> received_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> recorded_{0};
+
+    mutable std::mutex statusMutex;     // guards the two members below
+    std::vector<TopicStatus> status;
+    std::string error;
+};
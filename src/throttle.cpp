@@ -0,0 +1,127 @@
+// -*- mode: C++; c-indent-level: 4; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+//
+//  throttle.cpp -- adaptive limits on the requests a session has in flight
+//
+//  Copyright (C) 2026  Whit Armstrong and Dirk Eddelbuettel
+//
+//  This file is part of Rblpapi
+//
+//  Rblpapi is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  Rblpapi is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Rblpapi.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#if defined(HaveBlp)
+
+#include <algorithm>
+#include <chrono>
+#include <throttle.h>
+
+namespace {
+    double now() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+void Throttle::configure(const Settings& settings) {
+    std::lock_guard<std::mutex> lock(mutex);
+    s = settings;
+    s.minWindow = std::max(s.minWindow, 1.0);
+    s.maxWindow = std::max(s.maxWindow, s.minWindow);
+    s.minCells = std::max(s.minCells, 1.0);
+    s.maxCells = std::max(s.maxCells, s.minCells);
+    // start optimistic, the first failure halves both
+    window_ = std::min(std::max(8.0, s.minWindow), s.maxWindow);
+    cells_ = s.maxCells;
+    tokens = s.burst;
+    refilled = now();
+}
+
+Throttle::Settings Throttle::settings() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return s;
+}
+
+bool Throttle::admit(size_t inflight, bool retry) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!s.enabled) return true;
+    const double t = now();
+    if (s.rate > 0.0) {
+        tokens = std::min(s.burst, tokens + (t - refilled) * s.rate);
+        refilled = t;
+    }
+    if (inflight >= static_cast<size_t>(window_) || (s.rate > 0.0 && tokens < 1.0)) {
+        if (!retry) ++c.delayed;
+        return false;
+    }
+    if (s.rate > 0.0) tokens -= 1.0;
+    ++c.admitted;
+    return true;
+}
+
+void Throttle::succeeded(double latency) {
+    std::lock_guard<std::mutex> lock(mutex);
+    srtt = srtt == 0.0 ? latency : 0.875 * srtt + 0.125 * latency;
+    if (!s.enabled) return;
+    const double t = now();
+    if (s.latency > 0.0 && latency > s.latency) {
+        ++c.slow;
+        decrease(t);
+        return;
+    }
+    const double before = window_;
+    window_ = std::min(s.maxWindow, window_ + 1.0 / window_);
+    if (static_cast<int>(window_) > static_cast<int>(before)) ++c.increases;
+    cells_ = std::min(s.maxCells, cells_ + s.minCells / window_);
+}
+
+void Throttle::failed() {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++c.failures;
+    if (s.enabled) decrease(now());
+}
+
+void Throttle::decrease(double t) {
+    // the responses of requests sent before the last decrease do not count
+    if (t - lastDecrease < std::max(srtt, 0.05)) return;
+    lastDecrease = t;
+    window_ = std::max(s.minWindow, window_ / 2.0);
+    cells_ = std::max(s.minCells, cells_ / 2.0);
+    ++c.decreases;
+}
+
+double Throttle::window() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return window_;
+}
+
+size_t Throttle::cells() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<size_t>(cells_);
+}
+
+double Throttle::meanLatency() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return srtt;
+}
+
+Throttle::Counters Throttle::counters() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return c;
+}
+
+void Throttle::reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    c = Counters();
+}
+
+#endif
@@ -0,0 +1,88 @@
+// -*- mode: C++; c-indent-level: 4; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+//
+//  throttle.h -- adaptive limits on the requests a session has in flight
+//
+//  Copyright (C) 2026  Whit Armstrong and Dirk Eddelbuettel
+//
+//  This file is part of Rblpapi
+//
+//  Rblpapi is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  Rblpapi is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with Rblpapi.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+
+// Adapts the number of requests a session has in flight, and the size of the
+// requests callers build, to what the server sustains, in the manner of TCP
+// congestion control: the window grows by one request per window of timely
+// responses and is halved by a request failure or by a response slower than
+// the latency target, at most once per round trip. The request size, in
+// securities times fields, follows the same rule. An optional token bucket
+// caps the rate at which requests are sent. Thread-safe.
+class Throttle {
+public:
+    struct Settings {
+        bool enabled = true;
+        double rate = 0.0;              // requests per second, zero for no limit
+        double burst = 10.0;            // tokens the bucket holds
+        double minWindow = 1.0;
+        double maxWindow = 64.0;
+        double latency = 0.0;           // seconds a response may take, zero for no target
+        double minCells = 500.0;
+        double maxCells = 10000.0;
+    };
+
+    struct Counters {
+        unsigned long long admitted = 0;    // requests let through
+        unsigned long long delayed = 0;     // of which had to wait for a slot or token
+        unsigned long long increases = 0;   // window grown by a whole request
+        unsigned long long decreases = 0;   // window and size halved
+        unsigned long long failures = 0;    // request failures seen
+        unsigned long long slow = 0;        // responses over the latency target
+    };
+
+    Throttle() { configure(Settings()); }
+
+    void configure(const Settings& settings);
+    Settings settings() const;
+
+    // whether a request may be sent with 'inflight' others outstanding,
+    // taking a token if so; a caller refused waits and asks again
+    bool admit(size_t inflight, bool retry);
+    // the final response of a request, 'latency' seconds after it was sent
+    void succeeded(double latency);
+    void failed();
+
+    double window() const;
+    // suggested largest request, in securities times fields
+    size_t cells() const;
+    double meanLatency() const;
+    Counters counters() const;
+    void reset();
+
+private:
+    void decrease(double now);          // with the lock held
+
+    mutable std::mutex mutex;
+    Settings s;
+    double window_;
+    double cells_;
+    double tokens;
+    double refilled;                    // time of the last refill, in seconds
+    double lastDecrease = -1.0e9;
+    double srtt = 0.0;                  // smoothed latency
+    Counters c;
+};